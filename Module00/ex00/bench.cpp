@@ -0,0 +1,52 @@
+#include "shout.hpp"
+#include "Bench.hpp"
+#include <cstdlib>
+#include <sstream>
+#include <string>
+
+/*
+** shout() is megaphone's work, timed in-process per input byte over WORDS
+** arguments of WORD_LENGTH characters. The ./megaphone runs go through
+** std::system(), so they measure /bin/sh plus fork/exec, i.e. process
+** start, more than anything megaphone itself does.
+*/
+static const int	ROUNDS = 200;
+static const int	SHOUT_ROUNDS = 20000;
+static const int	WORDS = 256;
+static const int	WORD_LENGTH = 64;
+
+int	main(void) {
+	std::string	command = "./megaphone";
+	std::string	words[WORDS];
+	long		status = 0;
+
+	for (int w = 0; w < WORDS; w++) {
+		for (int c = 0; c < WORD_LENGTH; c++)
+			words[w] += static_cast<char>('a' + (w + c) % 26);
+		command += ' ' + words[w];
+	}
+	command += " > /dev/null";
+
+	std::ostringstream	out;
+	long				produced = 0;
+	unsigned long long	start = Bench::now();
+	for (int r = 0; r < SHOUT_ROUNDS; r++) {
+		out.str("");
+		for (int w = 0; w < WORDS; w++)
+			shout(out, words[w].c_str());
+		produced += static_cast<long>(out.tellp());
+	}
+	Bench::report("megaphone", "shout", start,
+		static_cast<double>(SHOUT_ROUNDS) * WORDS * WORD_LENGTH, "byte", produced);
+
+	start = Bench::now();
+	for (int r = 0; r < ROUNDS; r++)
+		status += std::system(command.c_str());
+	Bench::report("megaphone", "process + sh, 256 words", start, ROUNDS, "run", status);
+
+	start = Bench::now();
+	for (int r = 0; r < ROUNDS; r++)
+		status += std::system("./megaphone > /dev/null");
+	Bench::report("megaphone", "process + sh, no argument", start, ROUNDS, "run", status);
+	return status != 0;
+}
@@ -10,22 +10,15 @@
 /*                                                                            */
 /* ************************************************************************** */
 
-#include <iostream>
-#include <cctype>
+#include "shout.hpp"
 
 int	main(int ac, char **av)
 {
 	int	i = 1;
-	int	j;
 
 	if (ac == 1)
 		return (std::cout << "* LOUD AND UNBEARABLE FEEDBACK NOISE *" << std::endl, 0);
 	while (av[i])
-	{
-		j = 0;
-		while (av[i][j])
-			std::cout << static_cast<char>(std::toupper(static_cast<unsigned char>(av[i][j++])));
-		i++;
-	}
+		shout(std::cout, av[i++]);
 	return (std::cout << std::endl, 0);
 }
\ No newline at end of file
@@ -0,0 +1,18 @@
+#include "shout.hpp"
+#include <cctype>
+
+// Upper-cases through a stack buffer: one write per 256 bytes, not per character.
+void	shout(std::ostream& out, char const* word)
+{
+	char	buffer[256];
+	size_t	length = 0;
+
+	for (; *word; word++) {
+		buffer[length++] = static_cast<char>(std::toupper(static_cast<unsigned char>(*word)));
+		if (length == sizeof(buffer)) {
+			out.write(buffer, length);
+			length = 0;
+		}
+	}
+	out.write(buffer, length);
+}
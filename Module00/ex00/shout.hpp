@@ -0,0 +1,8 @@
+#ifndef SHOUT_HPP
+# define SHOUT_HPP
+# include <iostream>
+
+// Writes word to out in upper case (megaphone's work for one argument).
+void	shout(std::ostream& out, char const* word);
+
+#endif
@@ -16,6 +16,7 @@ PhoneBook::PhoneBook() : _insertIndex(0) {}
 
 void	PhoneBook::addContact(std::string firstName, std::string lastName, std::string nickName, std::string phoneNumber, std::string darkestSecret)
 {
+	TRACE_SPAN("PhoneBook::addContact");
 	_contacts[_insertIndex].setContact(firstName, lastName, nickName, phoneNumber, darkestSecret);
 	_insertIndex = (_insertIndex + 1) % 8;
 }
@@ -28,6 +29,7 @@ void	PhoneBook::truncateAndReplace(std::string &str) {
 }	
 
 void	PhoneBook::printContacts() {
+	TRACE_SPAN("PhoneBook::printContacts");
 	std::string separator = "+----------+----------+----------+----------+\n";
 	std::cout << separator
 				<< std::right
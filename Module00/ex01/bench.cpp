@@ -0,0 +1,46 @@
+#include "PhoneBook.hpp"
+#include "Bench.hpp"
+#include <sstream>
+#include <string>
+
+static const int	ADDS = 1 << 20;
+static const int	PRINTS = 1 << 16;
+
+// PhoneBook prints to std::cout: the timed loops write into sink instead.
+int	main(void) {
+	PhoneBook			phoneBook;
+	std::ostringstream	sink;
+	std::streambuf*		console = std::cout.rdbuf();
+	std::string			names[8] = {"Arthur", "Bartholomew", "Cleo", "Dimitrios-Alexandros",
+								"Eve", "Fitzgerald", "Gus", "Hildegard"};
+	long				written = 0;
+
+	// Eight slots: after the first round every add overwrites the oldest.
+	unsigned long long start = Bench::now();
+	for (int i = 0; i < ADDS; i++)
+		phoneBook.addContact(names[i & 7], names[(i + 3) & 7], names[(i + 5) & 7],
+			"0612345678", "likes benchmarks");
+	Bench::report("PhoneBook", "addContact", start, ADDS, "contact", ADDS);
+
+	std::cout.rdbuf(sink.rdbuf());
+	start = Bench::now();
+	for (int i = 0; i < PRINTS; i++) {
+		phoneBook.printContacts();
+		written += sink.tellp();
+		sink.str("");
+	}
+	std::cout.rdbuf(console);
+	Bench::report("PhoneBook", "printContacts (8 rows)", start, PRINTS, "table", written);
+
+	written = 0;
+	std::cout.rdbuf(sink.rdbuf());
+	start = Bench::now();
+	for (int i = 0; i < PRINTS; i++) {
+		phoneBook.printContactById(i & 7);
+		written += sink.tellp();
+		sink.str("");
+	}
+	std::cout.rdbuf(console);
+	Bench::report("PhoneBook", "printContactById", start, PRINTS, "contact", written);
+	return 0;
+}
@@ -9,6 +9,7 @@
 
 void	add_contact(std::string &firstName, std::string &lastName, std::string &nickName, std::string &phoneNumber, std::string &secret)
 {
+	TRACE_SPAN("prompt add_contact");
 	while (firstName.empty())
 	{
 		std::cout << "Entrez votre firstName: ";
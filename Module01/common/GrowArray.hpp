@@ -0,0 +1,20 @@
+#ifndef GROWARRAY_HPP
+#define GROWARRAY_HPP
+
+#include <cstddef>
+
+/*
+** Replaces array by a new[] block of capacity elements holding its first
+** count ones; the growable buffers of the exercises (no STL containers).
+*/
+template <class T>
+void	growArray(T*& array, size_t count, size_t capacity) {
+	T* grown = new T[capacity];
+
+	for (size_t i = 0; i < count; i++)
+		grown[i] = array[i];
+	delete[] array;
+	array = grown;
+}
+
+#endif
@@ -0,0 +1,159 @@
+#include "LifetimeProfiler.hpp"
+
+#ifdef LIFETIME_PROFILE
+
+# include <iostream>
+# include <iomanip>
+# include <cstdlib>
+# include <cstring>
+# include <ctime>
+# include <new>
+# include <pthread.h>
+
+static const int	MAX_TYPES = 16;
+static const int	BUCKETS = 40;
+
+struct TypeStats {
+	unsigned long	constructed;
+	unsigned long	destroyed;
+	unsigned long	allocs;
+	unsigned long	arrayAllocs;
+	unsigned long	frees;
+	unsigned long	bytesAllocated;
+	unsigned long	bytesFreed;
+	unsigned long	lifetimes[BUCKETS];
+};
+
+// One block per thread, linked once under the lock and never freed, so the
+// report can still read counters of threads that already exited.
+struct ThreadStats {
+	TypeStats		types[MAX_TYPES];
+	ThreadStats*	next;
+};
+
+static pthread_mutex_t	g_lock = PTHREAD_MUTEX_INITIALIZER;
+static ThreadStats*		g_threads = NULL;
+static char const*		g_names[MAX_TYPES];
+static int				g_typeCount = 0;
+static __thread ThreadStats*	t_stats = NULL;
+
+static TypeStats&	local(int slot) {
+	if (!t_stats) {
+		t_stats = new ThreadStats();
+		pthread_mutex_lock(&g_lock);
+		t_stats->next = g_threads;
+		g_threads = t_stats;
+		pthread_mutex_unlock(&g_lock);
+	}
+	return t_stats->types[slot];
+}
+
+static unsigned long long	nowNs(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<unsigned long long>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+static void	reportAtExit(void) {
+	LifetimeProfiler::report();
+}
+
+int	LifetimeProfiler::registerType(char const* name) {
+	int slot;
+
+	pthread_mutex_lock(&g_lock);
+	for (slot = 0; slot < g_typeCount; slot++) {
+		if (std::strcmp(g_names[slot], name) == 0)
+			break;
+	}
+	if (slot == g_typeCount && g_typeCount < MAX_TYPES) {
+		if (g_typeCount == 0)
+			std::atexit(reportAtExit);
+		g_names[g_typeCount++] = name;
+	}
+	pthread_mutex_unlock(&g_lock);
+	// Past MAX_TYPES every extra type is folded into the last slot.
+	return slot < MAX_TYPES ? slot : MAX_TYPES - 1;
+};
+
+unsigned long long	LifetimeProfiler::onBirth(int slot) {
+	local(slot).constructed++;
+	return nowNs();
+};
+
+void	LifetimeProfiler::onDeath(int slot, unsigned long long birth) {
+	TypeStats&			stats = local(slot);
+	unsigned long long	elapsed = nowNs() - birth;
+	int					bucket = 0;
+
+	stats.destroyed++;
+	while (elapsed > 1 && bucket < BUCKETS - 1) {
+		elapsed >>= 1;
+		bucket++;
+	}
+	stats.lifetimes[bucket]++;
+};
+
+// size is what operator new got, bytes what the report counts (no stamps).
+void*	LifetimeProfiler::allocate(int slot, size_t size, size_t bytes, bool array) {
+	TypeStats& stats = local(slot);
+
+	stats.allocs++;
+	if (array)
+		stats.arrayAllocs++;
+	stats.bytesAllocated += bytes;
+	return ::operator new(size);
+};
+
+void	LifetimeProfiler::release(int slot, void* ptr, size_t bytes, bool array) {
+	TypeStats& stats = local(slot);
+
+	(void)array;
+	if (ptr) {
+		stats.frees++;
+		stats.bytesFreed += bytes;
+	}
+	::operator delete(ptr);
+};
+
+/*
+** Sums every thread's counters. Meant to run at exit, once worker threads are
+** done; "alive" objects and "leaked" bytes are what was never destroyed/freed.
+** Lifetime buckets are powers of two in nanoseconds: [2^b, 2^(b+1)).
+*/
+void	LifetimeProfiler::report(void) {
+	pthread_mutex_lock(&g_lock);
+	for (int slot = 0; slot < g_typeCount; slot++) {
+		TypeStats total;
+
+		std::memset(&total, 0, sizeof(total));
+		for (ThreadStats* t = g_threads; t; t = t->next) {
+			TypeStats const& s = t->types[slot];
+			total.constructed += s.constructed;
+			total.destroyed += s.destroyed;
+			total.allocs += s.allocs;
+			total.arrayAllocs += s.arrayAllocs;
+			total.frees += s.frees;
+			total.bytesAllocated += s.bytesAllocated;
+			total.bytesFreed += s.bytesFreed;
+			for (int b = 0; b < BUCKETS; b++)
+				total.lifetimes[b] += s.lifetimes[b];
+		}
+		std::cerr << "[lifetime] " << g_names[slot] << ": "
+					<< total.constructed << " constructed, "
+					<< total.constructed - total.destroyed << " alive | heap: "
+					<< total.allocs << " allocs (" << total.arrayAllocs << " arrays), "
+					<< total.bytesAllocated << " bytes, "
+					<< total.allocs - total.frees << " blocks / "
+					<< total.bytesAllocated - total.bytesFreed << " bytes leaked\n";
+		for (int b = 0; b < BUCKETS; b++) {
+			if (total.lifetimes[b])
+				std::cerr << "[lifetime]   " << std::setw(12) << (1ULL << b) << " ns+ : "
+							<< total.lifetimes[b] << "\n";
+		}
+	}
+	pthread_mutex_unlock(&g_lock);
+};
+
+#endif
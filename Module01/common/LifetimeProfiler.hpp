@@ -0,0 +1,82 @@
+#ifndef LIFETIMEPROFILER_HPP
+#define LIFETIMEPROFILER_HPP
+
+#include <cstddef>
+
+/*
+** Opt-in allocation and lifetime profiling, enabled with -DLIFETIME_PROFILE
+** (`make PROFILE=1`). Put LIFETIME_PROFILED_CLASS(Type) at the end of a class
+** body: it adds class-level operator new/delete (heap counts and bytes) and a
+** stamp member that times each object from construction to destruction.
+** Counters are per-thread and merged into a report on stderr at exit.
+** Without the flag the macro expands to nothing: no member, no call, no cost.
+**
+** The stamp (8 bytes) makes the profiled object bigger than the real one, so
+** heap bytes are counted without it: sizeof(LifetimeStamp<T>) less per
+** object. That is the unprofiled size whenever the other members already
+** end on 8 bytes (pointers, std::string); a class of a few chars or ints can
+** still show up to 7 bytes of extra padding per object.
+*/
+
+#ifdef LIFETIME_PROFILE
+
+class LifetimeProfiler {
+	private:
+		LifetimeProfiler();
+
+	public:
+		static int					registerType(char const* name);
+		static unsigned long long	onBirth(int slot);
+		static void					onDeath(int slot, unsigned long long birth);
+		static void*				allocate(int slot, size_t size, size_t bytes, bool array);
+		static void					release(int slot, void* ptr, size_t bytes, bool array);
+		static void					report(void);
+};
+
+template <class T>
+class LifetimeStamp {
+	private:
+		unsigned long long	_birth;
+
+	public:
+		LifetimeStamp() : _birth(LifetimeProfiler::onBirth(T::lifetimeSlot())) {}
+		LifetimeStamp(LifetimeStamp const&) : _birth(LifetimeProfiler::onBirth(T::lifetimeSlot())) {}
+		LifetimeStamp& operator=(LifetimeStamp const&) { return *this; }
+		~LifetimeStamp() { LifetimeProfiler::onDeath(T::lifetimeSlot(), _birth); }
+};
+
+// Bytes of a size-byte block of T without the stamps; an array cookie is
+// smaller than one object, so size / sizeof(T) is the object count.
+template <class T>
+size_t	lifetimePayload(size_t size) {
+	return size - size / sizeof(T) * sizeof(LifetimeStamp<T>);
+}
+
+# define LIFETIME_PROFILED_CLASS(T) \
+	public: \
+		static int	lifetimeSlot(void) { \
+			static int slot = LifetimeProfiler::registerType(#T); \
+			return slot; \
+		} \
+		static void*	operator new(size_t size) { \
+			return LifetimeProfiler::allocate(lifetimeSlot(), size, lifetimePayload<T>(size), false); \
+		} \
+		static void*	operator new[](size_t size) { \
+			return LifetimeProfiler::allocate(lifetimeSlot(), size, lifetimePayload<T>(size), true); \
+		} \
+		static void	operator delete(void* ptr, size_t size) { \
+			LifetimeProfiler::release(lifetimeSlot(), ptr, lifetimePayload<T>(size), false); \
+		} \
+		static void	operator delete[](void* ptr, size_t size) { \
+			LifetimeProfiler::release(lifetimeSlot(), ptr, lifetimePayload<T>(size), true); \
+		} \
+	private: \
+		LifetimeStamp<T>	_lifetimeStamp;
+
+#else
+
+# define LIFETIME_PROFILED_CLASS(T)
+
+#endif
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <iostream>
 #include <string>
+#include "../common/LifetimeProfiler.hpp"
 
 class Zombie {
 	private:
@@ -15,6 +16,8 @@ class Zombie {
 		
 
 		void	announce(void);
+
+		LIFETIME_PROFILED_CLASS(Zombie)
 };
 
 #endif
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include <iostream>
 #include <string>
+#include "../common/LifetimeProfiler.hpp"
 
 class Zombie {
 	private:
@@ -16,6 +17,8 @@ class Zombie {
 
 		void	announce(void);
 		void	setName(std::string name);
+
+		LIFETIME_PROFILED_CLASS(Zombie)
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,27 @@
+#include "Zombie.hpp"
+#include "Bench.hpp"
+#include <sstream>
+
+Zombie*	zombieHorde(int N, std::string name);
+
+static const int	HORDE = 1024;
+static const int	ROUNDS = 2048;
+
+int	main(void) {
+	std::ostringstream	sink;
+	std::streambuf*		console = std::cout.rdbuf(sink.rdbuf());
+	long				written = 0;
+
+	// Announcements and destructor messages go to the sink, as they would to a terminal.
+	unsigned long long start = Bench::now();
+	for (int r = 0; r < ROUNDS; r++) {
+		Zombie* horde = zombieHorde(HORDE, "Walker");
+		delete[] horde;
+		written += sink.tellp();
+		sink.str("");
+	}
+	std::cout.rdbuf(console);
+	Bench::report("zombieHorde", "zombieHorde + delete[]", start,
+		static_cast<double>(HORDE) * ROUNDS, "zombie", written);
+	return 0;
+}
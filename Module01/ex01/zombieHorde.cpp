@@ -1,6 +1,8 @@
 #include "Zombie.hpp"
+#include "../../common/Trace.hpp"
 
 Zombie*	zombieHorde(int N, std::string name) {
+	TRACE_SPAN("zombieHorde");
 	Zombie* horde = new Zombie[N];
 
 	for (int j = 0; j < N; j++) {
@@ -0,0 +1,292 @@
+#include "CombatEngine.h"
+#include "../common/GrowArray.hpp"
+#include <pthread.h>
+
+// Entities rendered per thread before the batch is written out.
+static const size_t		RENDER_BLOCK = 1 << 16;
+static const unsigned	MAX_THREADS = 64;
+
+CombatEngine::CombatEngine()
+	: _weapons(NULL), _weaponCount(0), _weaponCapacity(0),
+	_names(NULL), _weaponOf(NULL), _count(0), _capacity(0) {};
+
+CombatEngine::CombatEngine(CombatEngine const& src)
+	: _weapons(NULL), _weaponCount(0), _weaponCapacity(0),
+	_names(NULL), _weaponOf(NULL), _count(0), _capacity(0) {
+	copyFrom(src);
+};
+
+CombatEngine& CombatEngine::operator=(CombatEngine const& rhs) {
+	if (this != &rhs) {
+		release();
+		copyFrom(rhs);
+	}
+	return *this;
+};
+
+CombatEngine::~CombatEngine() {
+	release();
+};
+
+void	CombatEngine::copyFrom(CombatEngine const& src) {
+	_weaponCapacity = src._weaponCount;
+	_capacity = src._count;
+	if (_weaponCapacity)
+		_weapons = new Weapon[_weaponCapacity];
+	if (_capacity) {
+		_names = new std::string[_capacity];
+		_weaponOf = new long[_capacity];
+	}
+	for (_weaponCount = 0; _weaponCount < src._weaponCount; _weaponCount++)
+		_weapons[_weaponCount] = src._weapons[_weaponCount];
+	for (_count = 0; _count < src._count; _count++) {
+		_names[_count] = src._names[_count];
+		_weaponOf[_count] = src._weaponOf[_count];
+	}
+};
+
+void	CombatEngine::release() {
+	delete[] _weapons;
+	delete[] _names;
+	delete[] _weaponOf;
+	_weapons = NULL;
+	_names = NULL;
+	_weaponOf = NULL;
+	_weaponCount = _weaponCapacity = 0;
+	_count = _capacity = 0;
+};
+
+size_t	CombatEngine::addWeapon(std::string type) {
+	if (_weaponCount == _weaponCapacity) {
+		_weaponCapacity = _weaponCapacity ? _weaponCapacity * 2 : 8;
+		growArray(_weapons, _weaponCount, _weaponCapacity);
+	}
+	_weapons[_weaponCount].setType(type);
+	return _weaponCount++;
+};
+
+void	CombatEngine::setWeaponType(size_t weapon, std::string type) {
+	_weapons[weapon].setType(type);
+};
+
+const std::string&	CombatEngine::getWeaponType(size_t weapon) const {
+	return _weapons[weapon].getType();
+};
+
+size_t	CombatEngine::getWeaponCount() const {
+	return _weaponCount;
+};
+
+size_t	CombatEngine::addCombatant(std::string name, long weapon) {
+	if (_count == _capacity) {
+		_capacity = _capacity ? _capacity * 2 : 64;
+		growArray(_names, _count, _capacity);
+		growArray(_weaponOf, _count, _capacity);
+	}
+	_names[_count] = name;
+	_weaponOf[_count] = weapon;
+	return _count++;
+};
+
+void	CombatEngine::setWeapon(size_t combatant, long weapon) {
+	_weaponOf[combatant] = weapon;
+};
+
+size_t	CombatEngine::getCombatantCount() const {
+	return _count;
+};
+
+// Same lines as HumanA::attack / HumanB::attack, appended to one buffer.
+void	CombatEngine::renderRange(size_t begin, size_t end, std::string& out) const {
+	for (size_t i = begin; i < end; i++) {
+		if (_weaponOf[i] == NO_WEAPON)
+			Weapon::appendUnarmedLine(out, _names[i]);
+		else
+			_weapons[_weaponOf[i]].appendAttackLine(out, _names[i]);
+	}
+};
+
+void	CombatEngine::countRange(size_t begin, size_t end, unsigned long* perWeapon, unsigned long& unarmed) const {
+	for (size_t i = begin; i < end; i++) {
+		if (_weaponOf[i] == NO_WEAPON)
+			unarmed++;
+		else
+			perWeapon[_weaponOf[i]]++;
+	}
+};
+
+struct CombatJob {
+	CombatEngine const*	engine;
+	size_t				begin;
+	size_t				end;
+	unsigned long*		perWeapon;
+	unsigned long		unarmed;
+};
+
+static void*	countJob(void* arg) {
+	CombatJob* job = static_cast<CombatJob*>(arg);
+
+	job->engine->countRange(job->begin, job->end, job->perWeapon, job->unarmed);
+	return NULL;
+}
+
+// Runs fn on each job, jobs[0] on the calling thread.
+static void	runJobs(CombatJob* jobs, unsigned count, void* (*fn)(void*)) {
+	pthread_t	threads[MAX_THREADS];
+	unsigned	started = 1;
+
+	for (; started < count; started++) {
+		if (pthread_create(&threads[started], NULL, fn, &jobs[started]) != 0)
+			break;
+	}
+	for (unsigned i = started; i < count; i++)
+		fn(&jobs[i]);
+	fn(&jobs[0]);
+	for (unsigned i = 1; i < started; i++)
+		pthread_join(threads[i], NULL);
+}
+
+static unsigned	clampThreads(unsigned threads) {
+	if (threads == 0)
+		return 1;
+	return threads > MAX_THREADS ? MAX_THREADS : threads;
+}
+
+/*
+** Render workers of one tick(), started once for all of its blocks. Round r
+** renders block r of every worker into text[worker][r & 1]; after the
+** round's barrier worker 0 writes them in order while the others already
+** render round r + 1 into the other buffer.
+*/
+struct TickShared {
+	CombatEngine const*	engine;
+	std::ostream*		out;
+	size_t				total;
+	unsigned			count;
+	bool				released;
+	unsigned			arrived;
+	unsigned long		generation;
+	pthread_mutex_t		lock;
+	pthread_cond_t		cond;
+	std::string			text[MAX_THREADS][2];
+};
+
+struct TickArg {
+	TickShared*	shared;
+	unsigned	id;
+};
+
+static void	barrierWait(TickShared& shared) {
+	pthread_mutex_lock(&shared.lock);
+	unsigned long generation = shared.generation;
+	if (++shared.arrived == shared.count) {
+		shared.arrived = 0;
+		shared.generation++;
+		pthread_cond_broadcast(&shared.cond);
+	}
+	else {
+		while (generation == shared.generation)
+			pthread_cond_wait(&shared.cond, &shared.lock);
+	}
+	pthread_mutex_unlock(&shared.lock);
+}
+
+static void	renderRounds(TickShared& shared, unsigned id) {
+	size_t	total = shared.total;
+	size_t	round = 0;
+
+	for (size_t base = 0; base < total; base += RENDER_BLOCK * shared.count, round++) {
+		size_t			begin = base + id * RENDER_BLOCK;
+		std::string&	text = shared.text[id][round & 1];
+
+		begin = begin < total ? begin : total;
+		text.clear();
+		shared.engine->renderRange(begin, begin + RENDER_BLOCK < total ? begin + RENDER_BLOCK : total, text);
+		barrierWait(shared);
+		if (id == 0) {
+			for (unsigned t = 0; t < shared.count; t++)
+				shared.out->write(shared.text[t][round & 1].data(), shared.text[t][round & 1].size());
+		}
+	}
+}
+
+// Waits until tick() knows how many workers started: that count sizes the rounds.
+static void*	tickWorker(void* arg) {
+	TickArg*	tick = static_cast<TickArg*>(arg);
+	TickShared&	shared = *tick->shared;
+
+	pthread_mutex_lock(&shared.lock);
+	while (!shared.released)
+		pthread_cond_wait(&shared.cond, &shared.lock);
+	pthread_mutex_unlock(&shared.lock);
+	renderRounds(shared, tick->id);
+	return NULL;
+}
+
+/*
+** One attack per combatant, in order. Each block of RENDER_BLOCK entities per
+** thread is rendered in parallel into per-thread buffers, then written with
+** one call per buffer, so the output is identical for any thread count.
+*/
+void	CombatEngine::tick(std::ostream& out, unsigned threads) const {
+	unsigned	count = clampThreads(threads);
+	TickShared*	shared = new TickShared;
+	TickArg		args[MAX_THREADS];
+	pthread_t	ids[MAX_THREADS];
+	unsigned	started = 1;
+
+	shared->engine = this;
+	shared->out = &out;
+	shared->total = _count;
+	shared->released = false;
+	shared->arrived = 0;
+	shared->generation = 0;
+	pthread_mutex_init(&shared->lock, NULL);
+	pthread_cond_init(&shared->cond, NULL);
+	for (; started < count; started++) {
+		args[started].shared = shared;
+		args[started].id = started;
+		if (pthread_create(&ids[started], NULL, tickWorker, &args[started]) != 0)
+			break;
+	}
+
+	pthread_mutex_lock(&shared->lock);
+	shared->count = started;
+	shared->released = true;
+	pthread_cond_broadcast(&shared->cond);
+	pthread_mutex_unlock(&shared->lock);
+	renderRounds(*shared, 0);
+	for (unsigned i = 1; i < started; i++)
+		pthread_join(ids[i], NULL);
+
+	pthread_mutex_destroy(&shared->lock);
+	pthread_cond_destroy(&shared->cond);
+	delete shared;
+	out.flush();
+};
+
+// Aggregated tick: perWeapon must hold getWeaponCount() counters, which are
+// incremented (not reset) along with unarmed.
+void	CombatEngine::tickStats(unsigned long* perWeapon, unsigned long& unarmed, unsigned threads) const {
+	unsigned	count = clampThreads(threads);
+	CombatJob	jobs[MAX_THREADS];
+	size_t		slice = (_count + count - 1) / count;
+
+	for (unsigned t = 0; t < count; t++) {
+		size_t begin = t * slice;
+		jobs[t].engine = this;
+		jobs[t].begin = begin < _count ? begin : _count;
+		jobs[t].end = begin + slice < _count ? begin + slice : _count;
+		jobs[t].perWeapon = new unsigned long[_weaponCount + 1];
+		for (size_t w = 0; w < _weaponCount; w++)
+			jobs[t].perWeapon[w] = 0;
+		jobs[t].unarmed = 0;
+	}
+	runJobs(jobs, count, countJob);
+	for (unsigned t = 0; t < count; t++) {
+		for (size_t w = 0; w < _weaponCount; w++)
+			perWeapon[w] += jobs[t].perWeapon[w];
+		unarmed += jobs[t].unarmed;
+		delete[] jobs[t].perWeapon;
+	}
+};
@@ -0,0 +1,51 @@
+#ifndef COMBATENGINE_H
+#define COMBATENGINE_H
+#include <iostream>
+#include <string>
+#include "Weapon.h"
+
+/*
+** Batch version of HumanA/HumanB: combatants live in packed arrays and refer
+** to weapons by index, so a tick is a linear scan instead of pointer chasing.
+** A combatant with NO_WEAPON behaves like an unarmed HumanB, and
+** setWeaponType() is seen by every later attack, like Weapon::setType().
+*/
+class CombatEngine {
+	private:
+		Weapon*			_weapons;
+		size_t			_weaponCount;
+		size_t			_weaponCapacity;
+
+		std::string*	_names;
+		long*			_weaponOf;
+		size_t			_count;
+		size_t			_capacity;
+
+		void	copyFrom(CombatEngine const& src);
+		void	release();
+
+	public:
+		static const long	NO_WEAPON = -1;
+
+		CombatEngine();
+		CombatEngine(CombatEngine const& src);
+		CombatEngine& operator=(CombatEngine const& rhs);
+		~CombatEngine();
+
+		size_t				addWeapon(std::string type);
+		void				setWeaponType(size_t weapon, std::string type);
+		const std::string&	getWeaponType(size_t weapon) const;
+		size_t				getWeaponCount() const;
+
+		size_t	addCombatant(std::string name, long weapon);
+		void	setWeapon(size_t combatant, long weapon);
+		size_t	getCombatantCount() const;
+
+		void	renderRange(size_t begin, size_t end, std::string& out) const;
+		void	countRange(size_t begin, size_t end, unsigned long* perWeapon, unsigned long& unarmed) const;
+
+		void	tick(std::ostream& out, unsigned threads = 1) const;
+		void	tickStats(unsigned long* perWeapon, unsigned long& unarmed, unsigned threads = 1) const;
+};
+
+#endif
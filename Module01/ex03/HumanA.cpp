@@ -1,8 +1,17 @@
 #include "HumanA.h"
 #include <iostream>
 
-HumanA::HumanA(std::string name, Weapon& weapon): _name(name), _weapon(weapon) {};
+HumanA::HumanA(std::string name, Weapon& weapon): _name(name), _weapon(weapon), _lineVersion(0) {};
+
+// The line is rebuilt only when the weapon's version moved since last time.
+void	HumanA::renderLine() {
+	_line.clear();
+	_weapon.appendAttackLine(_line, _name);
+	_lineVersion = _weapon.getVersion();
+};
 
 void	HumanA::attack() {
-	std::cout << _name << " attacks with their " << _weapon.getType() << std::endl;
+	if (_lineVersion != _weapon.getVersion())
+		renderLine();
+	std::cout << _line;
 };
@@ -5,8 +5,12 @@
 
 class HumanA {
 	private:
-		std::string _name;
-		Weapon& 			_weapon;
+		std::string 	_name;
+		Weapon& 		_weapon;
+		std::string		_line;
+		unsigned long	_lineVersion;
+
+		void	renderLine();
 
 	public:
 		HumanA(std::string _name, Weapon& weapon);
@@ -1,16 +1,25 @@
 #include "HumanB.h"
 #include <iostream>
 
-HumanB::HumanB(std::string name): _name(name), _weapon(NULL) {};
+HumanB::HumanB(std::string name): _name(name), _weapon(NULL), _lineVersion(0), _lineValid(false) {};
 
-
-void	HumanB::attack() {
+void	HumanB::renderLine() {
+	_line.clear();
 	if (_weapon)
-		std::cout << _name << " attacks with their " << _weapon->getType() << std::endl;
+		_weapon->appendAttackLine(_line, _name);
 	else
-		std::cout << _name << " has no weapon " << std::endl;
+		Weapon::appendUnarmedLine(_line, _name);
+	_lineVersion = _weapon ? _weapon->getVersion() : 0;
+	_lineValid = true;
+};
+
+void	HumanB::attack() {
+	if (!_lineValid || (_weapon && _lineVersion != _weapon->getVersion()))
+		renderLine();
+	std::cout << _line;
 };
 
 void	HumanB::setWeapon(Weapon& weapon) {
 	_weapon = &weapon;
+	_lineValid = false;
 };
\ No newline at end of file
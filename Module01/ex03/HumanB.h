@@ -5,8 +5,13 @@
 
 class HumanB {
 	private:
-		std::string _name;
-		Weapon* 			_weapon;
+		std::string 	_name;
+		Weapon* 		_weapon;
+		std::string		_line;
+		unsigned long	_lineVersion;
+		bool			_lineValid;
+
+		void	renderLine();
 
 	public:
 		HumanB(std::string name);
@@ -1,7 +1,18 @@
 #include "Weapon.h"
 
-Weapon::Weapon() : _type("") {};
-Weapon::Weapon(std::string type) : _type(type) {};
+// Versions start at 1 so that 0 can mean "nothing cached yet" for observers.
+Weapon::Weapon() : _type(""), _version(1) {};
+Weapon::Weapon(std::string type) : _type(type), _version(1) {};
+Weapon::Weapon(Weapon const& src) : _type(src._type), _version(1) {};
+
+// Assignment changes the type like setType, so it must bump the version too.
+Weapon& Weapon::operator=(Weapon const& rhs) {
+	if (this != &rhs) {
+		_type = rhs._type;
+		_version++;
+	}
+	return *this;
+};
 
 const std::string&	Weapon::getType() const {
 	return _type;
@@ -9,4 +20,22 @@ const std::string&	Weapon::getType() const {
 
 void	Weapon::setType(std::string type) {
 	_type = type;
-}
\ No newline at end of file
+	_version++;
+}
+
+unsigned long	Weapon::getVersion() const {
+	return _version;
+}
+
+// The attack lines of HumanA, HumanB and CombatEngine: one definition each.
+void	Weapon::appendAttackLine(std::string& out, std::string const& name) const {
+	out += name;
+	out += " attacks with their ";
+	out += _type;
+	out += '\n';
+};
+
+void	Weapon::appendUnarmedLine(std::string& out, std::string const& name) {
+	out += name;
+	out += " has no weapon \n";
+};
@@ -4,14 +4,21 @@
 
 class Weapon {
 	private:
-		std::string _type;
+		std::string		_type;
+		unsigned long	_version;
 
 	public:
 		Weapon();
 		Weapon(std::string type);
+		Weapon(Weapon const& src);
+		Weapon& operator=(Weapon const& rhs);
 
 		const std::string&		getType() const;
 		void					setType(std::string type);
+		unsigned long			getVersion() const;
+
+		void					appendAttackLine(std::string& out, std::string const& name) const;
+		static void				appendUnarmedLine(std::string& out, std::string const& name);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "CombatEngine.h"
+#include "HumanA.h"
+#include "HumanB.h"
+#include "Bench.hpp"
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+/*
+** One frame is one attack per combatant, written to /dev/null. HumanB
+** objects attacking through std::cout are the baseline; CombatEngine::tick
+** renders the same lines in blocks, tickStats only counts them.
+*/
+static const size_t	ENTITIES = 1 << 21;
+static const size_t	HUMANS = 1 << 18;
+static const int	WEAPONS = 16;
+static const int	FRAMES = 4;
+
+static std::string	nameOf(size_t i) {
+	std::ostringstream os;
+
+	os << "fighter" << i;
+	return os.str();
+}
+
+static void	benchHumans(std::ofstream& devNull) {
+	Weapon*		weapons = new Weapon[WEAPONS];
+	HumanB**	humans = new HumanB*[HUMANS];
+
+	for (int w = 0; w < WEAPONS; w++)
+		weapons[w].setType(nameOf(w) + " blade");
+	for (size_t i = 0; i < HUMANS; i++) {
+		humans[i] = new HumanB(nameOf(i));
+		if (i % 8)
+			humans[i]->setWeapon(weapons[i % WEAPONS]);
+	}
+
+	std::streambuf*		saved = std::cout.rdbuf(devNull.rdbuf());
+	unsigned long long	start = Bench::now();
+	for (int f = 0; f < FRAMES; f++)
+		for (size_t i = 0; i < HUMANS; i++)
+			humans[i]->attack();
+	std::cout.flush();
+	std::cout.rdbuf(saved);
+	Bench::report("CombatEngine", "HumanB::attack", start,
+		static_cast<double>(HUMANS) * FRAMES, "entity", HUMANS);
+
+	for (size_t i = 0; i < HUMANS; i++)
+		delete humans[i];
+	delete[] humans;
+	delete[] weapons;
+}
+
+int	main(void) {
+	std::ofstream	devNull("/dev/null");
+	CombatEngine	engine;
+	long			cores = sysconf(_SC_NPROCESSORS_ONLN);
+	unsigned		threads = cores > 1 ? static_cast<unsigned>(cores) : 1;
+
+	benchHumans(devNull);
+	for (int w = 0; w < WEAPONS; w++)
+		engine.addWeapon(nameOf(w) + " blade");
+	for (size_t i = 0; i < ENTITIES; i++)
+		engine.addCombatant(nameOf(i), i % 8 ? static_cast<long>(i % WEAPONS) : CombatEngine::NO_WEAPON);
+
+	double				ops = static_cast<double>(ENTITIES) * FRAMES;
+	unsigned long long	start = Bench::now();
+	for (int f = 0; f < FRAMES; f++)
+		engine.tick(devNull, 1);
+	Bench::report("CombatEngine", "tick, 1 thread", start, ops, "entity", ENTITIES);
+
+	start = Bench::now();
+	for (int f = 0; f < FRAMES; f++)
+		engine.tick(devNull, threads);
+	Bench::report("CombatEngine", "tick, all cores", start, ops, "entity", ENTITIES);
+
+	unsigned long	perWeapon[WEAPONS];
+	unsigned long	unarmed = 0;
+	for (int w = 0; w < WEAPONS; w++)
+		perWeapon[w] = 0;
+	start = Bench::now();
+	for (int f = 0; f < FRAMES; f++)
+		engine.tickStats(perWeapon, unarmed, 1);
+	Bench::report("CombatEngine", "tickStats, 1 thread", start, ops, "entity", unarmed);
+
+	unarmed = 0;
+	start = Bench::now();
+	for (int f = 0; f < FRAMES; f++)
+		engine.tickStats(perWeapon, unarmed, threads);
+	Bench::report("CombatEngine", "tickStats, all cores", start, ops, "entity", unarmed);
+	return 0;
+}
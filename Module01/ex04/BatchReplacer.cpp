@@ -0,0 +1,525 @@
+#include "BatchReplacer.hpp"
+#include "../common/GrowArray.hpp"
+#include "FileHandler.hpp"
+#include "IoRing.hpp"
+#include "WorkPool.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <dirent.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Serializes error lines from the workers.
+static pthread_mutex_t	g_errorLock = PTHREAD_MUTEX_INITIALIZER;
+
+BatchReplacer::BatchReplacer()
+	: _ringIo(true), _paths(NULL), _count(0), _capacity(0), _failed(0), _bytesRead(0), _bytesWritten(0) {};
+
+BatchReplacer::BatchReplacer(BatchReplacer const& src)
+	: _ringIo(true), _paths(NULL), _count(0), _capacity(0), _failed(0), _bytesRead(0), _bytesWritten(0) {
+	copyFrom(src);
+};
+
+BatchReplacer& BatchReplacer::operator=(BatchReplacer const& rhs) {
+	if (this != &rhs) {
+		release();
+		copyFrom(rhs);
+	}
+	return *this;
+};
+
+BatchReplacer::~BatchReplacer() {
+	release();
+};
+
+void	BatchReplacer::copyFrom(BatchReplacer const& src) {
+	_occurence = src._occurence;
+	_replaceStr = src._replaceStr;
+	_pattern = src._pattern;
+	_ringIo = src._ringIo;
+	_capacity = src._count;
+	if (_capacity)
+		_paths = new std::string[_capacity];
+	for (_count = 0; _count < src._count; _count++)
+		_paths[_count] = src._paths[_count];
+	_failed = src._failed;
+	_bytesRead = src._bytesRead;
+	_bytesWritten = src._bytesWritten;
+};
+
+void	BatchReplacer::release() {
+	delete[] _paths;
+	_paths = NULL;
+	_count = _capacity = 0;
+};
+
+void	BatchReplacer::setOccurence(std::string occurence) {
+	_occurence = occurence;
+};
+
+void	BatchReplacer::setReplaceStr(std::string replaceStr) {
+	_replaceStr = replaceStr;
+};
+
+// Same as FileHandler::usePattern().
+bool	BatchReplacer::usePattern() {
+	if (!_pattern.compile(_occurence, _replaceStr)) {
+		std::cerr << "Error: invalid pattern: " << _pattern.getError() << "\n";
+		return (false);
+	}
+	return (true);
+};
+
+// io_uring when the kernel allows it (the default), pread/pwrite otherwise.
+void	BatchReplacer::setRingIo(bool enabled) {
+	_ringIo = enabled;
+};
+
+void	BatchReplacer::addFile(std::string const& path) {
+	if (_count == _capacity) {
+		_capacity = _capacity ? _capacity * 2 : 64;
+		growArray(_paths, _count, _capacity);
+	}
+	_paths[_count++] = path;
+};
+
+// A directory is scanned recursively, any other file is read as a list.
+bool	BatchReplacer::addSource(std::string const& path) {
+	struct stat	info;
+
+	if (stat(path.c_str(), &info) != 0) {
+		std::cerr << "Error: cannot open " << path << ": " << std::strerror(errno) << "\n";
+		return (false);
+	}
+	if (S_ISDIR(info.st_mode))
+		return addDirectory(path);
+	return addList(path);
+};
+
+// One path per line; empty lines are skipped, a trailing '\r' is dropped.
+bool	BatchReplacer::addList(std::string const& path) {
+	std::ifstream	list(path.c_str());
+	std::string		line;
+
+	if (!list.is_open()) {
+		std::cerr << "Error: cannot open " << path << "\n";
+		return (false);
+	}
+	while (std::getline(list, line)) {
+		if (!line.empty() && line[line.size() - 1] == '\r')
+			line.erase(line.size() - 1);
+		if (!line.empty())
+			addFile(line);
+	}
+	return (true);
+};
+
+static bool	endsWith(char const* name, char const* suffix) {
+	size_t length = std::strlen(name);
+	size_t suffixLength = std::strlen(suffix);
+
+	return length >= suffixLength && std::strcmp(name + length - suffixLength, suffix) == 0;
+}
+
+/*
+** Regular files of the tree, outputs of an earlier run (*.replace) excepted
+** so that runs can be repeated. Symbolic links to files are followed, links
+** to directories are not (no cycles).
+*/
+bool	BatchReplacer::addDirectory(std::string const& path) {
+	DIR*	dir = opendir(path.c_str());
+	dirent*	entry;
+
+	if (!dir) {
+		std::cerr << "Error: cannot open " << path << ": " << std::strerror(errno) << "\n";
+		return (false);
+	}
+	bool ok = true;
+	while ((entry = readdir(dir)) != NULL) {
+		char const*	name = entry->d_name;
+		std::string	child = path;
+		struct stat	info;
+
+		if (std::strcmp(name, ".") == 0 || std::strcmp(name, "..") == 0)
+			continue;
+		if (child[child.size() - 1] != '/')
+			child += '/';
+		child += name;
+		if (lstat(child.c_str(), &info) != 0)
+			continue;
+		if (S_ISDIR(info.st_mode))
+			ok = addDirectory(child) && ok;
+		else if ((S_ISREG(info.st_mode)
+			|| (S_ISLNK(info.st_mode) && stat(child.c_str(), &info) == 0 && S_ISREG(info.st_mode)))
+			&& !endsWith(name, ".replace"))
+			addFile(child);
+	}
+	closedir(dir);
+	return ok;
+};
+
+// The whole file into content (capacity kept between files); errno on failure.
+static bool	readFile(char const* path, std::string& content) {
+	int			fd = open(path, O_RDONLY);
+	struct stat	info;
+	size_t		done = 0;
+
+	if (fd < 0)
+		return false;
+	if (fstat(fd, &info) != 0) {
+		close(fd);
+		return false;
+	}
+	content.resize(info.st_size);
+	while (done < content.size()) {
+		ssize_t n = pread(fd, &content[done], content.size() - done, done);
+
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n < 0) {
+			int saved = errno;
+			close(fd);
+			errno = saved;
+			return false;
+		}
+		if (n == 0)
+			break;
+		done += n;
+	}
+	content.resize(done);
+	close(fd);
+	return true;
+}
+
+static bool	writeFile(char const* path, std::string const& content) {
+	int		fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	size_t	done = 0;
+
+	if (fd < 0)
+		return false;
+	while (done < content.size()) {
+		ssize_t n = pwrite(fd, content.data() + done, content.size() - done, done);
+
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n < 0) {
+			int saved = errno;
+			close(fd);
+			errno = saved;
+			return false;
+		}
+		done += n;
+	}
+	return close(fd) == 0;
+}
+
+// Files per pool task: each one has a read or a write in flight on the ring.
+static const size_t	GROUP_FILES = 16;
+// A ring request moves at most 4 GiB - 1 bytes (32-bit length).
+static const size_t	RING_CHUNK = 1 << 30;
+
+// One file of a group. The buffers are reused from one group to the next.
+struct BatchFile {
+	std::string	input;
+	std::string	output;
+	std::string	outputPath;
+	int			fd;
+	size_t		done;
+	bool		writing;
+	int			error;
+};
+
+struct BatchWorker {
+	Pattern				pattern;
+	IoRing				ring;
+	BatchFile			files[GROUP_FILES];
+	size_t				failed;
+	unsigned long long	bytesRead;
+	unsigned long long	bytesWritten;
+};
+
+struct BatchRun {
+	std::string const*	occurence;
+	std::string const*	replaceStr;
+	std::string const*	paths;
+	size_t				count;
+	size_t				perTask;
+	BatchWorker*		workers;
+};
+
+static void	replaceInto(BatchRun const& run, BatchWorker& work, BatchFile& file) {
+	if (work.pattern.isCompiled())
+		work.pattern.replaceAll(file.input, file.output);
+	else
+		FileHandler::replaceLiteral(file.input, *run.occurence, *run.replaceStr, file.output);
+}
+
+// Opens path and sizes input to it; errno on failure.
+static bool	openInput(char const* path, BatchFile& file) {
+	struct stat info;
+
+	file.fd = open(path, O_RDONLY);
+	if (file.fd < 0)
+		return false;
+	if (fstat(file.fd, &info) != 0) {
+		int saved = errno;
+		close(file.fd);
+		file.fd = -1;
+		errno = saved;
+		return false;
+	}
+	file.input.resize(info.st_size);
+	return true;
+}
+
+static void	fail(BatchFile& file, int error) {
+	if (file.fd >= 0)
+		close(file.fd);
+	file.fd = -1;
+	file.error = error;
+}
+
+// The rest of the current read or write of file (tag) on the ring.
+static void	queueNext(IoRing& ring, BatchFile& file, unsigned tag) {
+	std::string&	buffer = file.writing ? file.output : file.input;
+	size_t			length = buffer.size() - file.done;
+
+	if (length > RING_CHUNK)
+		length = RING_CHUNK;
+	if (file.writing)
+		ring.queueWrite(file.fd, buffer.data() + file.done, length, file.done, tag);
+	else
+		ring.queueRead(file.fd, &buffer[file.done], length, file.done, tag);
+}
+
+static void	finishWrite(BatchFile& file) {
+	int result = close(file.fd);
+
+	file.fd = -1;
+	if (result != 0)
+		file.error = errno;
+}
+
+// Input complete: replace, then queue the output (empty outputs are done).
+static void	finishRead(BatchRun const& run, BatchWorker& work, BatchFile& file, unsigned tag) {
+	close(file.fd);
+	file.input.resize(file.done);
+	replaceInto(run, work, file);
+	file.writing = true;
+	file.done = 0;
+	file.fd = open(file.outputPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (file.fd < 0)
+		file.error = errno;
+	else if (file.output.empty())
+		finishWrite(file);
+	else
+		queueNext(work.ring, file, tag);
+}
+
+static void	runBlocking(BatchRun const& run, BatchWorker& work, BatchFile& file, std::string const& path) {
+	if (!readFile(path.c_str(), file.input)) {
+		file.error = errno;
+		return;
+	}
+	replaceInto(run, work, file);
+	file.writing = true;
+	if (!writeFile(file.outputPath.c_str(), file.output))
+		file.error = errno;
+}
+
+/*
+** Every file of the group has its read, then its write, queued on the
+** worker's ring as soon as the previous step completes; the worker replaces
+** in one file while the kernel moves the others. Opens and closes stay
+** plain system calls.
+**
+** If the ring itself fails, what it still holds is drained before it is
+** released, and the files it had not finished start over with pread/pwrite,
+** as do the following groups of this worker.
+*/
+static void	runRing(BatchRun const& run, BatchWorker& work, size_t first, size_t count) {
+	IoRing&				ring = work.ring;
+	unsigned long long	tag;
+	int					result;
+
+	for (size_t k = 0; k < count; k++) {
+		BatchFile& file = work.files[k];
+
+		if (!openInput(run.paths[first + k].c_str(), file))
+			file.error = errno;
+		else if (file.input.empty())
+			finishRead(run, work, file, k);
+		else
+			queueNext(ring, file, k);
+	}
+	while (ring.inFlight()) {
+		if (!ring.submit(1)) {
+			ring.drain();
+			ring = IoRing();
+			for (size_t k = 0; k < count; k++) {
+				BatchFile& file = work.files[k];
+
+				if (file.fd < 0)
+					continue;
+				close(file.fd);
+				file.fd = -1;
+				file.output.clear();
+				file.writing = false;
+				file.error = 0;
+				runBlocking(run, work, file, run.paths[first + k]);
+			}
+			return;
+		}
+		while (ring.complete(tag, result)) {
+			BatchFile& file = work.files[tag];
+
+			if (result == -EINTR || result == -EAGAIN)
+				queueNext(ring, file, tag);
+			else if (result < 0 || (result == 0 && file.writing))
+				fail(file, result < 0 ? -result : EIO);
+			else if (result == 0)
+				finishRead(run, work, file, tag);
+			else if ((file.done += result) < (file.writing ? file.output : file.input).size())
+				queueNext(ring, file, tag);
+			else if (file.writing)
+				finishWrite(file);
+			else
+				finishRead(run, work, file, tag);
+		}
+	}
+}
+
+void	BatchReplacer::processGroup(size_t index, unsigned worker, void* context) {
+	TRACE_SPAN("BatchReplacer::processGroup");
+	BatchRun*		run = static_cast<BatchRun*>(context);
+	BatchWorker&	work = run->workers[worker];
+	size_t			first = index * run->perTask;
+	size_t			count = run->count - first < run->perTask ? run->count - first : run->perTask;
+
+	for (size_t k = 0; k < count; k++) {
+		BatchFile& file = work.files[k];
+
+		file.outputPath = run->paths[first + k];
+		file.outputPath += ".replace";
+		file.output.clear();
+		file.fd = -1;
+		file.done = 0;
+		file.writing = false;
+		file.error = 0;
+	}
+	if (work.ring.isOpen())
+		runRing(*run, work, first, count);
+	else {
+		for (size_t k = 0; k < count; k++)
+			runBlocking(*run, work, work.files[k], run->paths[first + k]);
+	}
+
+	for (size_t k = 0; k < count; k++) {
+		BatchFile const& file = work.files[k];
+
+		if (file.error) {
+			std::string line = (file.writing ? "Error: cannot create " + file.outputPath
+				: "Error: cannot read " + run->paths[first + k]) + ": " + std::strerror(file.error) + "\n";
+
+			pthread_mutex_lock(&g_errorLock);
+			std::cerr << line;
+			pthread_mutex_unlock(&g_errorLock);
+			work.failed++;
+			continue;
+		}
+		work.bytesRead += file.input.size();
+		work.bytesWritten += file.output.size();
+	}
+};
+
+/*
+** Replaces in every added file; returns how many could not be read or written.
+** Tasks are groups of up to GROUP_FILES files, small enough that every
+** worker still gets about four of them to balance.
+*/
+// threads 0: defaultThreads() for the I/O the workers will actually get.
+size_t	BatchReplacer::run(unsigned threads) {
+	IoRing			probe;
+	bool			ring = _ringIo && probe.setup(GROUP_FILES);
+
+	probe = IoRing();
+	if (threads == 0)
+		threads = defaultThreads(ring);
+
+	size_t			perTask = _count / (WorkPool::workerCount(_count, threads) * 4);
+	BatchRun		batch;
+
+	if (perTask > GROUP_FILES)
+		perTask = GROUP_FILES;
+	if (perTask == 0)
+		perTask = 1;
+
+	size_t			tasks = (_count + perTask - 1) / perTask;
+	unsigned		workers = WorkPool::workerCount(tasks, threads);
+	BatchWorker*	state = new BatchWorker[workers];
+
+	for (unsigned w = 0; w < workers; w++) {
+		if (_pattern.isCompiled())
+			state[w].pattern = _pattern;
+		if (ring)
+			state[w].ring.setup(GROUP_FILES);
+		state[w].failed = 0;
+		state[w].bytesRead = 0;
+		state[w].bytesWritten = 0;
+	}
+	batch.occurence = &_occurence;
+	batch.replaceStr = &_replaceStr;
+	batch.paths = _paths;
+	batch.count = _count;
+	batch.perTask = perTask;
+	batch.workers = state;
+	WorkPool::run(tasks, workers, processGroup, &batch);
+
+	_failed = 0;
+	_bytesRead = 0;
+	_bytesWritten = 0;
+	for (unsigned w = 0; w < workers; w++) {
+		_failed += state[w].failed;
+		_bytesRead += state[w].bytesRead;
+		_bytesWritten += state[w].bytesWritten;
+	}
+	delete[] state;
+	return _failed;
+};
+
+size_t	BatchReplacer::getFileCount() const {
+	return _count;
+};
+
+size_t	BatchReplacer::getFailedCount() const {
+	return _failed;
+};
+
+unsigned long long	BatchReplacer::getBytesRead() const {
+	return _bytesRead;
+};
+
+unsigned long long	BatchReplacer::getBytesWritten() const {
+	return _bytesWritten;
+};
+
+/*
+** One worker per online core with rings: a worker never blocks on the disk,
+** and more of them only share the cores. Blocked in pread/pwrite, half of
+** the workers are usually waiting, so twice as many keep the cores busy.
+*/
+unsigned	BatchReplacer::defaultThreads(bool ringIo) {
+	long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	long threads;
+
+	if (cores < 1)
+		cores = 1;
+	threads = ringIo ? cores : cores * 2;
+	if (threads > static_cast<long>(WorkPool::MAX_THREADS))
+		return WorkPool::MAX_THREADS;
+	return static_cast<unsigned>(threads);
+};
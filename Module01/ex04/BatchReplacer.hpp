@@ -0,0 +1,66 @@
+#ifndef BATCHREPLACER_HPP
+# define BATCHREPLACER_HPP
+# include <string>
+# include "../../common/Trace.hpp"
+# include "Pattern.hpp"
+
+/*
+** Batch mode (-b): one process replaces in every file of a list (one path
+** per line) or of a directory tree, each into its own <file>.replace, with
+** the literal / -E semantics of FileHandler. Files are read and written
+** whole, byte for byte.
+**
+** Groups of files are the tasks of a WorkPool. Each worker keeps its own
+** Pattern copy (the lazy DFA caches are not shared), its own buffers,
+** reused from one group to the next, and its own IoRing: the reads and
+** writes of a whole group are in flight together while the worker replaces
+** in the files already read. Where io_uring is unavailable, workers read and
+** write with pread/pwrite instead, blocking, and run(0) starts twice as
+** many workers as cores to keep requests in flight (one per core otherwise).
+*/
+class BatchReplacer {
+	private:
+		std::string			_occurence;
+		std::string			_replaceStr;
+		Pattern				_pattern;
+		bool				_ringIo;
+
+		std::string*		_paths;
+		size_t				_count;
+		size_t				_capacity;
+
+		size_t				_failed;
+		unsigned long long	_bytesRead;
+		unsigned long long	_bytesWritten;
+
+		void	copyFrom(BatchReplacer const& src);
+		void	release();
+		bool	addList(std::string const& path);
+		bool	addDirectory(std::string const& path);
+
+		static void	processGroup(size_t index, unsigned worker, void* context);
+
+	public:
+		BatchReplacer();
+		BatchReplacer(BatchReplacer const& src);
+		BatchReplacer& operator=(BatchReplacer const& rhs);
+		~BatchReplacer();
+
+		void	setOccurence(std::string occurence);
+		void	setReplaceStr(std::string replaceStr);
+		bool	usePattern();
+		void	setRingIo(bool enabled);
+
+		void	addFile(std::string const& path);
+		bool	addSource(std::string const& path);
+		size_t	run(unsigned threads);
+
+		size_t				getFileCount() const;
+		size_t				getFailedCount() const;
+		unsigned long long	getBytesRead() const;
+		unsigned long long	getBytesWritten() const;
+
+		static unsigned	defaultThreads(bool ringIo);
+};
+
+#endif
@@ -3,6 +3,7 @@
 FileHandler::FileHandler(std::string newFileName) : _outputFileName(newFileName) {};
 
 void	FileHandler::exportFileContent() {
+	TRACE_SPAN("FileHandler::exportFileContent");
 	std::ofstream outfile(_outputFileName.c_str());
 
 	if (!outfile.is_open()) {
@@ -15,21 +16,38 @@ void	FileHandler::exportFileContent() {
 };
 
 void	FileHandler::replaceOccurence() {
+	TRACE_SPAN("FileHandler::replaceOccurence");
+
+	if (_pattern.isCompiled())
+		_pattern.replaceAll(_fileContent, _outputFileContent);
+	else
+		replaceLiteral(_fileContent, _occurence, _replaceStr, _outputFileContent);
+};
+
+// Appends input to output with every occurence replaced; an empty occurence
+// matches nothing.
+void	FileHandler::replaceLiteral(std::string const& input, std::string const& occurence,
+	std::string const& replaceStr, std::string& output) {
 	size_t subPos = 0;
 	size_t pos = 0;
 
-	while ((subPos = _fileContent.find(_occurence, pos)) != std::string::npos)
+	if (occurence.empty()) {
+		output += input;
+		return;
+	}
+	while ((subPos = input.find(occurence, pos)) != std::string::npos)
 	{
-		_outputFileContent.append(_fileContent, pos, subPos - pos);
+		output.append(input, pos, subPos - pos);
 
-		_outputFileContent += _replaceStr;
+		output += replaceStr;
 
-		pos = subPos + _occurence.length();
+		pos = subPos + occurence.length();
 	}
-	_outputFileContent.append(_fileContent, pos, std::string::npos);
+	output.append(input, pos, std::string::npos);
 };
 
 bool	FileHandler::setFileContent(std::string path) {
+	TRACE_SPAN("FileHandler::setFileContent");
 	std::ifstream file(path.c_str());
 	if (!file.is_open()) {
 		std::cerr << "Error: cannont open file\n";
@@ -48,6 +66,16 @@ bool	FileHandler::setFileContent(std::string path) {
 	return (true);
 };
 
+// Switches replaceOccurence() to pattern mode: the occurence is compiled as
+// a pattern and the replace string may refer to its groups (see Pattern.hpp).
+bool	FileHandler::usePattern() {
+	if (!_pattern.compile(_occurence, _replaceStr)) {
+		std::cerr << "Error: invalid pattern: " << _pattern.getError() << "\n";
+		return (false);
+	}
+	return (true);
+};
+
 void	FileHandler::setOccurence(std::string occurence) {
 	_occurence = occurence;
 };
@@ -3,6 +3,8 @@
 # include <iostream>
 # include <fstream>
 # include <string>
+# include "../../common/Trace.hpp"
+# include "Pattern.hpp"
 
 class FileHandler {
 	private:
@@ -11,6 +13,7 @@ class FileHandler {
 		std::string	_occurence;
 		std::string _replaceStr;
 		std::string _outputFileContent;
+		Pattern		_pattern;
 
 	public:
 		FileHandler(std::string newFileName);
@@ -21,6 +24,10 @@ class FileHandler {
 		void	setOccurence(std::string occurence);
 		void	setReplaceStr(std::string path);
 		bool	setFileContent(std::string path);
+		bool	usePattern();
+
+		static void	replaceLiteral(std::string const& input, std::string const& occurence,
+						std::string const& replaceStr, std::string& output);
 
 		const	std::string&	getFileContext() const;
 		const	std::string&	getOutputFileContent() const;
@@ -0,0 +1,215 @@
+#include "IoRing.hpp"
+#include <cerrno>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+IoRing::IoRing()
+	: _fd(-1), _entries(0), _sqMap(NULL), _sqMapSize(0), _cqMap(NULL), _cqMapSize(0),
+	_sqes(NULL), _sqesSize(0), _sqHead(NULL), _sqTail(NULL), _sqArray(NULL), _sqMask(0),
+	_cqHead(NULL), _cqTail(NULL), _cqes(NULL), _cqMask(0), _queued(0), _inFlight(0) {};
+
+// The kernel side cannot be shared: a copy has to set itself up again.
+IoRing::IoRing(IoRing const& src)
+	: _fd(-1), _entries(0), _sqMap(NULL), _sqMapSize(0), _cqMap(NULL), _cqMapSize(0),
+	_sqes(NULL), _sqesSize(0), _sqHead(NULL), _sqTail(NULL), _sqArray(NULL), _sqMask(0),
+	_cqHead(NULL), _cqTail(NULL), _cqes(NULL), _cqMask(0), _queued(0), _inFlight(0) {
+	(void)src;
+};
+
+IoRing& IoRing::operator=(IoRing const& rhs) {
+	if (this != &rhs)
+		release();
+	return *this;
+};
+
+IoRing::~IoRing() {
+	release();
+};
+
+void	IoRing::release() {
+	if (_sqes)
+		munmap(_sqes, _sqesSize);
+	if (_cqMap && _cqMap != _sqMap)
+		munmap(_cqMap, _cqMapSize);
+	if (_sqMap)
+		munmap(_sqMap, _sqMapSize);
+	if (_fd >= 0)
+		close(_fd);
+	_fd = -1;
+	_entries = 0;
+	_sqMap = _cqMap = NULL;
+	_sqes = NULL;
+	_sqMapSize = _cqMapSize = _sqesSize = 0;
+	_queued = _inFlight = 0;
+};
+
+static void*	mapRing(int fd, size_t size, unsigned long long offset) {
+	void* map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+
+	return map == MAP_FAILED ? NULL : map;
+}
+
+// Room for entries requests in flight (the kernel rounds up to a power of two).
+bool	IoRing::setup(unsigned entries) {
+	io_uring_params	params;
+	int				saved;
+
+	release();
+	std::memset(&params, 0, sizeof(params));
+	_fd = syscall(__NR_io_uring_setup, entries, &params);
+	if (_fd < 0)
+		return false;
+	// IORING_OP_READ / WRITE came with 5.6, as did this feature bit.
+	if (!(params.features & IORING_FEAT_RW_CUR_POS)) {
+		release();
+		errno = ENOSYS;
+		return false;
+	}
+
+	_sqMapSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	_cqMapSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	if (params.features & IORING_FEAT_SINGLE_MMAP) {
+		if (_cqMapSize > _sqMapSize)
+			_sqMapSize = _cqMapSize;
+		_cqMapSize = _sqMapSize;
+	}
+	_sqMap = mapRing(_fd, _sqMapSize, IORING_OFF_SQ_RING);
+	if (_sqMap && (params.features & IORING_FEAT_SINGLE_MMAP))
+		_cqMap = _sqMap;
+	else if (_sqMap)
+		_cqMap = mapRing(_fd, _cqMapSize, IORING_OFF_CQ_RING);
+	_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+	if (_cqMap)
+		_sqes = static_cast<io_uring_sqe*>(mapRing(_fd, _sqesSize, IORING_OFF_SQES));
+	if (!_sqes) {
+		saved = errno;
+		release();
+		errno = saved;
+		return false;
+	}
+
+	char* sq = static_cast<char*>(_sqMap);
+	char* cq = static_cast<char*>(_cqMap);
+	_sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+	_sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+	_sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+	_sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+	_cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+	_cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+	_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+	_cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+	// The completion ring is at least as large: in-flight requests never overflow it.
+	_entries = params.sq_entries;
+	return true;
+};
+
+bool	IoRing::isOpen() const {
+	return _fd >= 0;
+};
+
+unsigned	IoRing::capacity() const {
+	return _entries;
+};
+
+unsigned	IoRing::inFlight() const {
+	return _inFlight;
+};
+
+/*
+** The kernel reads the submission tail and writes the completion tail from
+** other threads: a release store publishes a filled entry, an acquire load
+** makes completed entries visible before they are read.
+*/
+bool	IoRing::queue(int op, int fd, void const* buffer, unsigned length,
+	unsigned long long offset, unsigned long long tag) {
+	if (_inFlight == _entries)
+		return false;
+
+	unsigned		tail = *_sqTail;
+	unsigned		index = tail & _sqMask;
+	io_uring_sqe*	sqe = _sqes + index;
+
+	std::memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = op;
+	sqe->fd = fd;
+	sqe->addr = reinterpret_cast<unsigned long>(buffer);
+	sqe->len = length;
+	sqe->off = offset;
+	sqe->user_data = tag;
+	_sqArray[index] = index;
+	__atomic_store_n(_sqTail, tail + 1, __ATOMIC_RELEASE);
+	_queued++;
+	_inFlight++;
+	return true;
+};
+
+// false when the ring already holds capacity() requests.
+bool	IoRing::queueRead(int fd, void* buffer, unsigned length,
+	unsigned long long offset, unsigned long long tag) {
+	return queue(IORING_OP_READ, fd, buffer, length, offset, tag);
+};
+
+bool	IoRing::queueWrite(int fd, void const* buffer, unsigned length,
+	unsigned long long offset, unsigned long long tag) {
+	return queue(IORING_OP_WRITE, fd, buffer, length, offset, tag);
+};
+
+// Hands the queued requests to the kernel, then waits for waitFor completions.
+bool	IoRing::submit(unsigned waitFor) {
+	if (waitFor > _inFlight)
+		waitFor = _inFlight;
+	while (_queued || waitFor) {
+		long done = syscall(__NR_io_uring_enter, _fd, _queued, waitFor,
+			waitFor ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+
+		if (done < 0 && errno == EINTR)
+			continue;
+		if (done < 0)
+			return false;
+		_queued -= done;
+		if (!_queued)
+			break;
+	}
+	return true;
+};
+
+// Takes the next completion if one is ready.
+bool	IoRing::complete(unsigned long long& tag, int& result) {
+	unsigned head = *_cqHead;
+
+	if (head == __atomic_load_n(_cqTail, __ATOMIC_ACQUIRE))
+		return false;
+
+	io_uring_cqe const* cqe = _cqes + (head & _cqMask);
+	tag = cqe->user_data;
+	result = cqe->res;
+	__atomic_store_n(_cqHead, head + 1, __ATOMIC_RELEASE);
+	_inFlight--;
+	return true;
+};
+
+/*
+** Takes back the requests not handed to the kernel yet and waits out the
+** others, dropping every result: afterwards no request refers to a caller
+** buffer any more, so the buffers can be reused or the ring released.
+*/
+void	IoRing::drain() {
+	unsigned long long	tag;
+	int					result;
+
+	__atomic_store_n(_sqTail, *_sqTail - _queued, __ATOMIC_RELEASE);
+	_inFlight -= _queued;
+	_queued = 0;
+	while (_inFlight) {
+		if (complete(tag, result))
+			continue;
+
+		long done = syscall(__NR_io_uring_enter, _fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+		// Only a broken ring fails for good; its requests are gone with it.
+		if (done < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+			break;
+	}
+};
@@ -0,0 +1,64 @@
+#ifndef IORING_HPP
+# define IORING_HPP
+# include <cstddef>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+/*
+** io_uring through its two system calls, without liburing: the submission
+** and completion rings are mapped from the kernel and only reads and writes
+** are queued. Every request carries a tag that comes back with its result
+** (bytes transferred, or -errno).
+**
+** setup() fails with errno set when the kernel has no io_uring, forbids it
+** (io_uring_disabled, seccomp: ENOSYS, EPERM) or predates IORING_OP_READ;
+** callers then fall back to pread/pwrite. A ring is used by one thread at a
+** time. Copies start closed.
+*/
+class IoRing {
+	private:
+		int				_fd;
+		unsigned		_entries;
+		void*			_sqMap;
+		size_t			_sqMapSize;
+		void*			_cqMap;
+		size_t			_cqMapSize;
+		io_uring_sqe*	_sqes;
+		size_t			_sqesSize;
+		unsigned*		_sqHead;
+		unsigned*		_sqTail;
+		unsigned*		_sqArray;
+		unsigned		_sqMask;
+		unsigned*		_cqHead;
+		unsigned*		_cqTail;
+		io_uring_cqe*	_cqes;
+		unsigned		_cqMask;
+		unsigned		_queued;
+		unsigned		_inFlight;
+
+		void	release();
+		bool	queue(int op, int fd, void const* buffer, unsigned length,
+					unsigned long long offset, unsigned long long tag);
+
+	public:
+		IoRing();
+		IoRing(IoRing const& src);
+		IoRing& operator=(IoRing const& rhs);
+		~IoRing();
+
+		bool		setup(unsigned entries);
+		bool		isOpen() const;
+		unsigned	capacity() const;
+		unsigned	inFlight() const;
+
+		bool	queueRead(int fd, void* buffer, unsigned length,
+					unsigned long long offset, unsigned long long tag);
+		bool	queueWrite(int fd, void const* buffer, unsigned length,
+					unsigned long long offset, unsigned long long tag);
+		bool	submit(unsigned waitFor);
+		bool	complete(unsigned long long& tag, int& result);
+		void	drain();
+};
+
+#endif
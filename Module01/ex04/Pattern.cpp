@@ -0,0 +1,297 @@
+#include "Pattern.hpp"
+#include <cstring>
+#include <sstream>
+
+Pattern::Pattern()
+	: _compiled(false), _pieces(NULL), _pieceGroup(NULL), _pieceCount(0), _needsGroups(false),
+	_slotCount(0), _slots(NULL), _work(NULL), _threadPc(NULL), _threadSlots(NULL),
+	_visited(NULL), _generation(0) {};
+
+Pattern::Pattern(Pattern const& src)
+	: _compiled(false), _pieces(NULL), _pieceGroup(NULL), _pieceCount(0), _needsGroups(false),
+	_slotCount(0), _slots(NULL), _work(NULL), _threadPc(NULL), _threadSlots(NULL),
+	_visited(NULL), _generation(0) {
+	*this = src;
+};
+
+// Copies recompile from the source text: compiled state is all derived.
+Pattern& Pattern::operator=(Pattern const& rhs) {
+	if (this != &rhs) {
+		release();
+		_error = rhs._error;
+		if (rhs._compiled)
+			compile(rhs._source, rhs._replacement);
+	}
+	return *this;
+};
+
+Pattern::~Pattern() {
+	release();
+};
+
+void	Pattern::release() {
+	delete[] _pieces;
+	delete[] _pieceGroup;
+	delete[] _slots;
+	delete[] _work;
+	delete[] _threadPc;
+	delete[] _threadSlots;
+	delete[] _visited;
+	_pieces = NULL;
+	_pieceGroup = NULL;
+	_slots = NULL;
+	_work = NULL;
+	_threadPc = NULL;
+	_threadSlots = NULL;
+	_visited = NULL;
+	_pieceCount = 0;
+	_compiled = false;
+};
+
+bool	Pattern::compile(std::string const& pattern, std::string const& replacement) {
+	int				groups = 0;
+	PatternProgram	reversed;
+
+	release();
+	_source = pattern;
+	_replacement = replacement;
+	_error.clear();
+	if (pattern.empty()) {
+		_error = "empty pattern";
+		return false;
+	}
+
+	PatternNode* tree = PatternProgram::parse(pattern, groups, _error);
+	if (!tree)
+		return false;
+
+	bool ok = _program.build(tree, groups, false, _error) && reversed.build(tree, groups, true, _error);
+	PatternProgram::freeTree(tree);
+	if (!ok)
+		return false;
+	if (_program.matchesEmpty()) {
+		_error = "pattern can match an empty string";
+		return false;
+	}
+	if (!parseReplacement(replacement))
+		return false;
+
+	_forward = PatternDfa(_program, false);
+	_reverse = PatternDfa(reversed, true);
+	_slotCount = 2 * (groups + 1);
+	if (_needsGroups) {
+		int size = _program.size();
+		_slots = new long[_slotCount];
+		_work = new long[_slotCount];
+		_threadPc = new int[2 * size];
+		_threadSlots = new long[2 * static_cast<size_t>(size) * _slotCount];
+		_visited = new unsigned[size];
+		std::memset(_visited, 0, size * sizeof(unsigned));
+		_generation = 0;
+	}
+	_compiled = true;
+	return true;
+};
+
+// Splits the replacement into literal pieces and group references.
+bool	Pattern::parseReplacement(std::string const& replacement) {
+	size_t	count = 1;
+
+	for (size_t i = 0; i < replacement.size(); i++) {
+		if (replacement[i] == '\\')
+			count += 2;
+	}
+	_pieces = new std::string[count];
+	_pieceGroup = new int[count];
+	_pieceCount = 0;
+	_needsGroups = false;
+
+	std::string literal;
+	for (size_t i = 0; i < replacement.size(); i++) {
+		char c = replacement[i];
+
+		if (c != '\\' || i + 1 == replacement.size()) {
+			literal += c;
+			continue;
+		}
+		c = replacement[++i];
+		if (c < '0' || c > '9') {
+			literal += c == 'n' ? '\n' : c == 't' ? '\t' : c;
+			continue;
+		}
+
+		int group = c - '0';
+		if (group > _program.groups()) {
+			std::ostringstream os;
+			os << "replacement refers to group " << group << " but the pattern has "
+				<< _program.groups();
+			_error = os.str();
+			return false;
+		}
+		if (!literal.empty()) {
+			_pieces[_pieceCount] = literal;
+			_pieceGroup[_pieceCount++] = -1;
+			literal.clear();
+		}
+		_pieceGroup[_pieceCount++] = group;
+		if (group)
+			_needsGroups = true;
+	}
+	if (!literal.empty()) {
+		_pieces[_pieceCount] = literal;
+		_pieceGroup[_pieceCount++] = -1;
+	}
+	return true;
+};
+
+bool	Pattern::isCompiled() const {
+	return _compiled;
+};
+
+std::string const&	Pattern::getError() const {
+	return _error;
+};
+
+void	Pattern::nextGeneration() {
+	if (++_generation == 0) {
+		std::memset(_visited, 0, _program.size() * sizeof(unsigned));
+		_generation = 1;
+	}
+};
+
+// Adds pc and everything reachable without a byte to a thread list, with
+// _work as the capture slots; earlier additions have priority.
+void	Pattern::addThread(int list, int pc, size_t pos) {
+	PatternInst const& inst = _program.insts()[pc];
+
+	if (_visited[pc] == _generation)
+		return;
+	_visited[pc] = _generation;
+	if (inst.op == PatternInst::SPLIT) {
+		addThread(list, inst.out, pos);
+		addThread(list, inst.out1, pos);
+	}
+	else if (inst.op == PatternInst::SAVE) {
+		long saved = _work[inst.arg];
+		_work[inst.arg] = pos;
+		addThread(list, inst.out, pos);
+		_work[inst.arg] = saved;
+	}
+	else {
+		size_t thread = static_cast<size_t>(list) * _program.size() + _threadCount[list]++;
+		_threadPc[thread] = pc;
+		std::memcpy(_threadSlots + thread * _slotCount, _work, _slotCount * sizeof(long));
+	}
+};
+
+/*
+** Thread-list NFA simulation over [begin, end), which the DFAs already
+** proved to be a match: the highest-priority thread reaching MATCH exactly
+** at end gives the groups, earlier alternatives and longer repetitions first.
+*/
+bool	Pattern::captureGroups(char const* text, size_t begin, size_t end) {
+	PatternInst const*	insts = _program.insts();
+	int					current = 0;
+
+	for (int i = 0; i < _slotCount; i++)
+		_work[i] = -1;
+	_threadCount[0] = 0;
+	nextGeneration();
+	addThread(0, _program.start(), begin);
+	for (size_t pos = begin; _threadCount[current]; pos++) {
+		int next = 1 - current;
+
+		_threadCount[next] = 0;
+		nextGeneration();
+		for (int t = 0; t < _threadCount[current]; t++) {
+			size_t				thread = static_cast<size_t>(current) * _program.size() + t;
+			PatternInst const&	inst = insts[_threadPc[thread]];
+			long const*			slots = _threadSlots + thread * _slotCount;
+
+			if (inst.op == PatternInst::MATCH) {
+				if (pos == end) {
+					std::memcpy(_slots, slots, _slotCount * sizeof(long));
+					return true;
+				}
+			}
+			else if (pos < end && PatternProgram::hasByte(inst.bits, text[pos])) {
+				std::memcpy(_work, slots, _slotCount * sizeof(long));
+				addThread(next, inst.out, pos + 1);
+			}
+		}
+		if (pos == end)
+			break;
+		current = next;
+	}
+	return false;
+};
+
+void	Pattern::appendReplacement(std::string const& input, size_t begin, size_t end, std::string& output) {
+	if (_needsGroups && !captureGroups(input.data(), begin, end)) {
+		for (int i = 0; i < _slotCount; i++)
+			_slots[i] = -1;
+	}
+	for (int i = 0; i < _pieceCount; i++) {
+		int group = _pieceGroup[i];
+
+		if (group < 0)
+			output += _pieces[i];
+		else if (group == 0)
+			output.append(input, begin, end - begin);
+		else if (_slots[2 * group] >= 0 && _slots[2 * group + 1] >= 0)
+			output.append(input, _slots[2 * group], _slots[2 * group + 1] - _slots[2 * group]);
+	}
+};
+
+// First set bit of starts at or after pos, skipping empty 64-bit words.
+static size_t	nextStart(unsigned char const* starts, size_t pos, size_t length) {
+	while (pos < length) {
+		if ((pos & 63) == 0 && pos + 64 <= length) {
+			uint64_t word;
+			std::memcpy(&word, starts + (pos >> 3), sizeof(word));
+			if (!word) {
+				pos += 64;
+				continue;
+			}
+		}
+		if ((starts[pos >> 3] >> (pos & 7)) & 1)
+			return pos;
+		pos++;
+	}
+	return length;
+}
+
+// Appends input to output with every match replaced; returns the match count.
+size_t	Pattern::replaceAll(std::string const& input, std::string& output) {
+	char const*		text = input.data();
+	size_t			length = input.size();
+	unsigned char*	starts;
+	size_t			pos = 0;
+	size_t			copied = 0;
+	size_t			matches = 0;
+
+	if (!_compiled) {
+		output += input;
+		return 0;
+	}
+	output.reserve(output.size() + length);
+	starts = new unsigned char[length / 8 + 8]();
+	_reverse.markStarts(text, length, starts);
+	_forward.resetMemo();
+	while ((pos = nextStart(starts, pos, length)) < length) {
+		size_t begin = pos;
+		size_t end = _forward.longestMatch(text, begin, length);
+
+		if (end == begin) {
+			pos++;
+			continue;
+		}
+		output.append(input, copied, begin - copied);
+		appendReplacement(input, begin, end, output);
+		copied = pos = end;
+		matches++;
+	}
+	output.append(input, copied, std::string::npos);
+	delete[] starts;
+	return matches;
+};
@@ -0,0 +1,64 @@
+#ifndef PATTERN_HPP
+# define PATTERN_HPP
+# include <string>
+# include "PatternDfa.hpp"
+
+/*
+** Compiled pattern + replacement for the -E mode (syntax in
+** PatternProgram.hpp). Matches are leftmost-longest and never overlap;
+** patterns that can match the empty string are refused.
+**
+** replaceAll() makes one backward pass with the unanchored reverse DFA to
+** mark where matches start, then from each start the forward DFA finds the
+** longest end: every step is a table lookup, no backtracking. Scans that
+** run past their match (a*b|a over a long run of a) meet the states of the
+** previous scan and reuse its result (see PatternDfa.hpp), so the total
+** stays linear in the input for a given pattern. Capture
+** groups are only resolved (NFA simulation over the matched bytes) when
+** the replacement refers to them: \1 to \9, \0 for the whole match,
+** \\ for a backslash, \n and \t.
+*/
+class Pattern {
+	private:
+		std::string		_source;
+		std::string		_replacement;
+		std::string		_error;
+		bool			_compiled;
+		PatternProgram	_program;
+		PatternDfa		_forward;
+		PatternDfa		_reverse;
+
+		std::string*	_pieces;
+		int*			_pieceGroup;
+		int				_pieceCount;
+		bool			_needsGroups;
+
+		int				_slotCount;
+		long*			_slots;
+		long*			_work;
+		int*			_threadPc;
+		long*			_threadSlots;
+		int				_threadCount[2];
+		unsigned*		_visited;
+		unsigned		_generation;
+
+		void	release();
+		bool	parseReplacement(std::string const& replacement);
+		void	nextGeneration();
+		void	addThread(int list, int pc, size_t pos);
+		bool	captureGroups(char const* text, size_t begin, size_t end);
+		void	appendReplacement(std::string const& input, size_t begin, size_t end, std::string& output);
+
+	public:
+		Pattern();
+		Pattern(Pattern const& src);
+		Pattern& operator=(Pattern const& rhs);
+		~Pattern();
+
+		bool				compile(std::string const& pattern, std::string const& replacement);
+		bool				isCompiled() const;
+		std::string const&	getError() const;
+		size_t				replaceAll(std::string const& input, std::string& output);
+};
+
+#endif
@@ -0,0 +1,409 @@
+#include "PatternDfa.hpp"
+#include "../common/GrowArray.hpp"
+#include <cstring>
+
+PatternDfa::PatternDfa()
+	: _program(), _unanchored(false), _classCount(1), _rowWidth(2),
+	_pool(NULL), _poolSize(0), _poolCapacity(0), _setBegin(NULL), _setLength(NULL),
+	_trans(NULL), _stateCount(0), _stateCapacity(0), _table(NULL), _tableSize(0),
+	_startSet(NULL), _startLength(0), _stack(NULL), _members(NULL), _mark(NULL), _generation(0), _flushes(0),
+	_memoPos(NULL), _memoState(NULL), _memoEnd(NULL), _memoSize(0), _memoCount(0),
+	_pendingPos(NULL), _pendingState(NULL), _pendingCapacity(0) {};
+
+PatternDfa::PatternDfa(PatternProgram const& program, bool unanchored)
+	: _program(program), _unanchored(unanchored), _classCount(1), _rowWidth(2),
+	_pool(NULL), _poolSize(0), _poolCapacity(0), _setBegin(NULL), _setLength(NULL),
+	_trans(NULL), _stateCount(0), _stateCapacity(0), _table(NULL), _tableSize(0),
+	_startSet(NULL), _startLength(0), _stack(NULL), _members(NULL), _mark(NULL), _generation(0), _flushes(0),
+	_memoPos(NULL), _memoState(NULL), _memoEnd(NULL), _memoSize(0), _memoCount(0),
+	_pendingPos(NULL), _pendingState(NULL), _pendingCapacity(0) {
+	init();
+};
+
+// The cache is not copied: the copy rebuilds its states on demand.
+PatternDfa::PatternDfa(PatternDfa const& src)
+	: _program(src._program), _unanchored(src._unanchored), _classCount(1), _rowWidth(2),
+	_pool(NULL), _poolSize(0), _poolCapacity(0), _setBegin(NULL), _setLength(NULL),
+	_trans(NULL), _stateCount(0), _stateCapacity(0), _table(NULL), _tableSize(0),
+	_startSet(NULL), _startLength(0), _stack(NULL), _members(NULL), _mark(NULL), _generation(0), _flushes(0),
+	_memoPos(NULL), _memoState(NULL), _memoEnd(NULL), _memoSize(0), _memoCount(0),
+	_pendingPos(NULL), _pendingState(NULL), _pendingCapacity(0) {
+	if (_program.size())
+		init();
+};
+
+PatternDfa& PatternDfa::operator=(PatternDfa const& rhs) {
+	if (this != &rhs) {
+		release();
+		_program = rhs._program;
+		_unanchored = rhs._unanchored;
+		if (_program.size())
+			init();
+	}
+	return *this;
+};
+
+PatternDfa::~PatternDfa() {
+	release();
+};
+
+void	PatternDfa::release() {
+	delete[] _pool;
+	delete[] _setBegin;
+	delete[] _setLength;
+	delete[] _trans;
+	delete[] _table;
+	delete[] _startSet;
+	delete[] _stack;
+	delete[] _members;
+	delete[] _mark;
+	delete[] _memoPos;
+	delete[] _memoState;
+	delete[] _memoEnd;
+	delete[] _pendingPos;
+	delete[] _pendingState;
+	_pool = NULL;
+	_setBegin = NULL;
+	_setLength = NULL;
+	_trans = NULL;
+	_table = NULL;
+	_startSet = NULL;
+	_stack = NULL;
+	_members = NULL;
+	_mark = NULL;
+	_memoPos = NULL;
+	_memoState = NULL;
+	_memoEnd = NULL;
+	_pendingPos = NULL;
+	_pendingState = NULL;
+	_memoSize = _memoCount = _pendingCapacity = 0;
+	_poolSize = _poolCapacity = 0;
+	_stateCount = _stateCapacity = 0;
+	_tableSize = 0;
+	_startLength = 0;
+};
+
+void	PatternDfa::init() {
+	int size = _program.size();
+
+	_classCount = _program.classCount();
+	_rowWidth = _classCount + 1;
+	_stack = new int[size];
+	_members = new int[size];
+	_mark = new unsigned[size]();
+	_generation = 1;
+	closure(_program.start());
+	_startLength = collect();
+	_startSet = new int[_startLength ? _startLength : 1];
+	for (int i = 0; i < _startLength; i++)
+		_startSet[i] = _members[i];
+	flush();
+	for (int c = 0; c < 256; c++)
+		_keepsStart[c] = computeNext(0, _program.classOf()[c]) == 0;
+};
+
+// Drops every state (and the memo, which names them); the start set is
+// always state 0 afterwards.
+void	PatternDfa::flush() {
+	_flushes++;
+	resetMemo();
+	_poolSize = 0;
+	_stateCount = 0;
+	if (!_table) {
+		_tableSize = 64;
+		_table = new int[_tableSize];
+	}
+	for (int i = 0; i < _tableSize; i++)
+		_table[i] = -1;
+	findOrAdd(_startSet, _startLength);
+};
+
+// Marks every instruction reachable from pc without reading a byte.
+void	PatternDfa::closure(int pc) {
+	PatternInst const*	insts = _program.insts();
+	int					top = 0;
+
+	if (_mark[pc] == _generation)
+		return;
+	_mark[pc] = _generation;
+	_stack[top++] = pc;
+	while (top) {
+		PatternInst const& inst = insts[_stack[--top]];
+		int outs[2] = {-1, -1};
+
+		if (inst.op == PatternInst::SPLIT) {
+			outs[0] = inst.out;
+			outs[1] = inst.out1;
+		}
+		else if (inst.op == PatternInst::SAVE)
+			outs[0] = inst.out;
+		for (int k = 0; k < 2; k++) {
+			if (outs[k] >= 0 && _mark[outs[k]] != _generation) {
+				_mark[outs[k]] = _generation;
+				_stack[top++] = outs[k];
+			}
+		}
+	}
+};
+
+// Marked BYTES/MATCH instructions, in program order: the canonical state key.
+int	PatternDfa::collect() {
+	PatternInst const*	insts = _program.insts();
+	int					length = 0;
+
+	for (int pc = 0; pc < _program.size(); pc++) {
+		if (_mark[pc] == _generation
+			&& (insts[pc].op == PatternInst::BYTES || insts[pc].op == PatternInst::MATCH))
+			_members[length++] = pc;
+	}
+	return length;
+};
+
+static unsigned	hashSet(int const* set, int length) {
+	unsigned hash = 2166136261u;
+
+	for (int i = 0; i < length; i++)
+		hash = (hash ^ static_cast<unsigned>(set[i])) * 16777619u;
+	return hash;
+}
+
+// State for set[0, length), added if new; flushes the cache when full.
+int	PatternDfa::findOrAdd(int const* set, int length) {
+	unsigned	slot = hashSet(set, length) & (_tableSize - 1);
+
+	for (; _table[slot] >= 0; slot = (slot + 1) & (_tableSize - 1)) {
+		int state = _table[slot];
+		if (_setLength[state] == length
+			&& std::memcmp(_pool + _setBegin[state], set, length * sizeof(int)) == 0)
+			return state;
+	}
+	if (_stateCount == MAX_STATES) {
+		flush();
+		return findOrAdd(set, length);
+	}
+	if (_stateCount == _stateCapacity) {
+		size_t oldTrans = static_cast<size_t>(_stateCapacity) * _rowWidth;
+
+		_stateCapacity = _stateCapacity ? _stateCapacity * 2 : 16;
+		growArray(_setBegin, _stateCount, _stateCapacity);
+		growArray(_setLength, _stateCount, _stateCapacity);
+		growArray(_trans, oldTrans, static_cast<size_t>(_stateCapacity) * _rowWidth);
+	}
+	while (_poolSize + length > _poolCapacity) {
+		_poolCapacity = _poolCapacity ? _poolCapacity * 2 : 256;
+		growArray(_pool, _poolSize, _poolCapacity);
+	}
+
+	int		state = _stateCount++;
+	int*	row = _trans + static_cast<size_t>(state) * _rowWidth;
+
+	_setBegin[state] = _poolSize;
+	_setLength[state] = length;
+	for (int c = 0; c < _classCount; c++)
+		row[c] = UNKNOWN;
+	row[_classCount] = 0;
+	for (int i = 0; i < length; i++) {
+		_pool[_poolSize++] = set[i];
+		if (_program.insts()[set[i]].op == PatternInst::MATCH)
+			row[_classCount] = 1;
+	}
+	_table[slot] = state;
+
+	if (_stateCount * 2 > _tableSize) {
+		delete[] _table;
+		_tableSize *= 2;
+		_table = new int[_tableSize];
+		for (int i = 0; i < _tableSize; i++)
+			_table[i] = -1;
+		for (int s = 0; s < _stateCount; s++) {
+			unsigned h = hashSet(_pool + _setBegin[s], _setLength[s]) & (_tableSize - 1);
+			while (_table[h] >= 0)
+				h = (h + 1) & (_tableSize - 1);
+			_table[h] = s;
+		}
+	}
+	return state;
+};
+
+// Takes and returns row offsets (state * _rowWidth), DEAD when no NFA state survives.
+int	PatternDfa::computeNext(int row, int cls) {
+	PatternInst const*	insts = _program.insts();
+	int					state = row / _rowWidth;
+	unsigned char		c = _program.classRep()[cls];
+	int					next = DEAD;
+
+	if (++_generation == 0) {
+		std::memset(_mark, 0, _program.size() * sizeof(unsigned));
+		_generation = 1;
+	}
+	for (int i = 0; i < _setLength[state]; i++) {
+		PatternInst const& inst = insts[_pool[_setBegin[state] + i]];
+		if (inst.op == PatternInst::BYTES && PatternProgram::hasByte(inst.bits, c))
+			closure(inst.out);
+	}
+	if (_unanchored)
+		closure(_program.start());
+
+	int length = collect();
+	if (length) {
+		int before = _stateCount;
+		next = findOrAdd(_members, length) * _rowWidth;
+		// A flush renumbered every state: the old one has no row to fill.
+		if (_stateCount < before)
+			return next;
+	}
+	_trans[row + cls] = next;
+	return next;
+};
+
+/*
+** The scan loops keep the table in a local (writes through starts may alias
+** any member) and reload it after computeNext(), which can reallocate. A
+** state is its row offset, so a step is one load and one add; the last
+** column of a row is its accepting flag.
+*/
+
+// End of the longest match starting at begin, or begin when there is none.
+size_t	PatternDfa::longestMatch(char const* text, size_t begin, size_t end) {
+	unsigned char const*	classOf = _program.classOf();
+	int const				accept = _classCount;
+	int const*				trans = _trans;
+	unsigned const			flushes = _flushes;
+	size_t					last = begin;
+	size_t					pending = 0;
+	size_t					i = begin;
+	int						state = 0;
+
+	for (;;) {
+		size_t stop = (i / MEMO_STRIDE + 1) * MEMO_STRIDE;
+
+		if (stop > end)
+			stop = end;
+		for (; i < stop; i++) {
+			int cls = classOf[static_cast<unsigned char>(text[i])];
+			int next = trans[state + cls];
+
+			if (next == UNKNOWN) {
+				next = computeNext(state, cls);
+				trans = _trans;
+			}
+			state = next;
+			if (state == DEAD)
+				break;
+			if (trans[state + accept])
+				last = i + 1;
+		}
+		if (state == DEAD || i == end)
+			break;
+
+		size_t known;
+		if (memoFind(i, state, known)) {
+			if (known)
+				last = known;
+			break;
+		}
+		if (pending == _pendingCapacity) {
+			_pendingCapacity = _pendingCapacity ? _pendingCapacity * 2 : 64;
+			growArray(_pendingPos, pending, _pendingCapacity);
+			growArray(_pendingState, pending, _pendingCapacity);
+		}
+		_pendingPos[pending] = i;
+		_pendingState[pending++] = state;
+	}
+	// States met before a flush have been renumbered since.
+	if (_flushes == flushes) {
+		for (size_t k = 0; k < pending; k++)
+			memoStore(_pendingPos[k], _pendingState[k], last > _pendingPos[k] ? last : 0);
+	}
+	return last;
+};
+
+static size_t	memoSlot(size_t pos, int state, size_t mask) {
+	return ((pos / PatternDfa::MEMO_STRIDE) * 2654435761u ^ static_cast<size_t>(state) * 40503u) & mask;
+}
+
+// Last accepting end after pos for a scan in state there (0: none), if known.
+bool	PatternDfa::memoFind(size_t pos, int state, size_t& end) const {
+	if (!_memoCount)
+		return false;
+	for (size_t slot = memoSlot(pos, state, _memoSize - 1); _memoPos[slot];
+		slot = (slot + 1) & (_memoSize - 1)) {
+		if (_memoPos[slot] == pos && _memoState[slot] == state) {
+			end = _memoEnd[slot];
+			return true;
+		}
+	}
+	return false;
+};
+
+// Positions are multiples of MEMO_STRIDE, never 0: 0 marks a free slot.
+void	PatternDfa::memoStore(size_t pos, int state, size_t end) {
+	if ((_memoCount + 1) * 2 > _memoSize) {
+		size_t*	oldPos = _memoPos;
+		int*	oldState = _memoState;
+		size_t*	oldEnd = _memoEnd;
+		size_t	oldSize = _memoSize;
+
+		_memoSize = _memoSize ? _memoSize * 2 : 256;
+		_memoPos = new size_t[_memoSize]();
+		_memoState = new int[_memoSize];
+		_memoEnd = new size_t[_memoSize];
+		_memoCount = 0;
+		for (size_t k = 0; k < oldSize; k++) {
+			if (oldPos[k])
+				memoStore(oldPos[k], oldState[k], oldEnd[k]);
+		}
+		delete[] oldPos;
+		delete[] oldState;
+		delete[] oldEnd;
+	}
+
+	size_t slot = memoSlot(pos, state, _memoSize - 1);
+	while (_memoPos[slot])
+		slot = (slot + 1) & (_memoSize - 1);
+	_memoPos[slot] = pos;
+	_memoState[slot] = state;
+	_memoEnd[slot] = end;
+	_memoCount++;
+};
+
+void	PatternDfa::resetMemo() {
+	if (_memoCount)
+		std::memset(_memoPos, 0, _memoSize * sizeof(size_t));
+	_memoCount = 0;
+};
+
+/*
+** Meant for an unanchored DFA over the reversed program: scanning from the
+** end, an accepting state at i means some match of the pattern starts at i.
+** Sets those bits of starts (length bits, zeroed by the caller).
+*/
+void	PatternDfa::markStarts(char const* text, size_t length, unsigned char* starts) {
+	unsigned char const*	classOf = _program.classOf();
+	int const				accept = _classCount;
+	int const*				trans = _trans;
+	int						state = 0;
+
+	for (size_t i = length; i-- > 0;) {
+		// Bytes that keep the start state are skipped without a lookup chain.
+		if (state == 0) {
+			while (i > 0 && _keepsStart[static_cast<unsigned char>(text[i])])
+				i--;
+		}
+
+		int cls = classOf[static_cast<unsigned char>(text[i])];
+		int next = trans[state + cls];
+
+		if (next == UNKNOWN) {
+			next = computeNext(state, cls);
+			trans = _trans;
+		}
+		state = next == DEAD ? 0 : next;
+		if (trans[state + accept])
+			starts[i >> 3] |= 1 << (i & 7);
+	}
+};
+
+int	PatternDfa::getStateCount() const {
+	return _stateCount;
+};
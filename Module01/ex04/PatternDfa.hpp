@@ -0,0 +1,87 @@
+#ifndef PATTERNDFA_HPP
+# define PATTERNDFA_HPP
+# include "PatternProgram.hpp"
+
+/*
+** DFA over a PatternProgram, built lazily: a state is the set of NFA
+** positions reachable so far, created the first time a transition needs it
+** and cached with one transition per byte class. Scanning is then one table
+** lookup per byte. The cache is flushed when it reaches MAX_STATES, so
+** patterns with a huge DFA degrade to rebuilding states, never to
+** exponential memory.
+**
+** An unanchored DFA restarts the program at every position; markStarts()
+** runs one over the reversed program to find where matches begin.
+**
+** longestMatch() remembers, every MEMO_STRIDE bytes, which state it passed
+** there and the last accepting end that followed. A later scan over the
+** same text reaching a remembered (position, state) pair stops there, since
+** the rest of its run is already known, so all the scans of one text cost
+** at most its length times the states met (not length times matches).
+** resetMemo() before scanning another text.
+*/
+class PatternDfa {
+	private:
+		PatternProgram	_program;
+		bool			_unanchored;
+		int				_classCount;
+		int				_rowWidth;
+		bool			_keepsStart[256];
+
+		int*			_pool;
+		size_t			_poolSize;
+		size_t			_poolCapacity;
+		size_t*			_setBegin;
+		int*			_setLength;
+		int*			_trans;
+		int				_stateCount;
+		int				_stateCapacity;
+		int*			_table;
+		int				_tableSize;
+
+		int*			_startSet;
+		int				_startLength;
+		int*			_stack;
+		int*			_members;
+		unsigned*		_mark;
+		unsigned		_generation;
+		unsigned		_flushes;
+
+		size_t*			_memoPos;
+		int*			_memoState;
+		size_t*			_memoEnd;
+		size_t			_memoSize;
+		size_t			_memoCount;
+		size_t*			_pendingPos;
+		int*			_pendingState;
+		size_t			_pendingCapacity;
+
+		void	release();
+		void	init();
+		void	flush();
+		void	closure(int pc);
+		int		collect();
+		int		findOrAdd(int const* set, int length);
+		int		computeNext(int state, int cls);
+		bool	memoFind(size_t pos, int state, size_t& end) const;
+		void	memoStore(size_t pos, int state, size_t end);
+
+	public:
+		static const int	DEAD = -1;
+		static const int	UNKNOWN = -2;
+		static const int	MAX_STATES = 4096;
+		static const size_t	MEMO_STRIDE = 32;
+
+		PatternDfa();
+		PatternDfa(PatternProgram const& program, bool unanchored);
+		PatternDfa(PatternDfa const& src);
+		PatternDfa& operator=(PatternDfa const& rhs);
+		~PatternDfa();
+
+		size_t	longestMatch(char const* text, size_t begin, size_t end);
+		void	resetMemo();
+		void	markStarts(char const* text, size_t length, unsigned char* starts);
+		int		getStateCount() const;
+};
+
+#endif
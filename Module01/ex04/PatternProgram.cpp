@@ -0,0 +1,597 @@
+#include "PatternProgram.hpp"
+#include <cstring>
+#include <sstream>
+
+/*
+** Recursive descent parser:
+**   alternate := concat ('|' concat)*
+**   concat    := repeat*
+**   repeat    := atom ('*' | '+' | '?' | '{n}' | '{n,}' | '{n,m}')*
+**   atom      := '(' ['?:'] alternate ')' | '[' class ']' | '.' | '\' escape | byte
+** A '{' that does not start a bound is a literal byte.
+*/
+
+struct PatternParser {
+	char const*	begin;
+	char const*	p;
+	char const*	end;
+	int			groups;
+	std::string	error;
+};
+
+static const int	PARSE_ERROR = -2;
+static const int	SHORTHAND = -1;
+
+static PatternNode*	parseAlternate(PatternParser& ps);
+
+static void	fail(PatternParser& ps, char const* message) {
+	std::ostringstream os;
+
+	os << message << " at offset " << (ps.p - ps.begin);
+	ps.error = os.str();
+}
+
+static PatternNode*	newNode(int type) {
+	PatternNode* node = new PatternNode();
+
+	node->type = type;
+	node->group = -1;
+	return node;
+}
+
+static void	addRange(uint32_t* bits, int lo, int hi) {
+	for (int c = lo; c <= hi; c++)
+		bits[c >> 5] |= 1u << (c & 31);
+}
+
+static void	invert(uint32_t* bits) {
+	for (int i = 0; i < 8; i++)
+		bits[i] = ~bits[i];
+}
+
+// \d \w \s and their upper-case negations; false for any other letter.
+static bool	addShorthand(uint32_t* bits, char which) {
+	uint32_t	set[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+	char		lower = which | 0x20;
+
+	if (lower == 'd')
+		addRange(set, '0', '9');
+	else if (lower == 'w') {
+		addRange(set, '0', '9');
+		addRange(set, 'a', 'z');
+		addRange(set, 'A', 'Z');
+		addRange(set, '_', '_');
+	}
+	else if (lower == 's') {
+		addRange(set, '\t', '\r');
+		addRange(set, ' ', ' ');
+	}
+	else
+		return false;
+	if (which != lower)
+		invert(set);
+	for (int i = 0; i < 8; i++)
+		bits[i] |= set[i];
+	return true;
+}
+
+// Just after a backslash: the escaped byte, SHORTHAND (added to bits) or PARSE_ERROR.
+static int	parseEscape(PatternParser& ps, uint32_t* bits) {
+	if (ps.p == ps.end) {
+		fail(ps, "trailing backslash");
+		return PARSE_ERROR;
+	}
+
+	char c = *ps.p;
+	switch (c) {
+		case 'n': ps.p++; return '\n';
+		case 't': ps.p++; return '\t';
+		case 'r': ps.p++; return '\r';
+		case 'f': ps.p++; return '\f';
+		case 'v': ps.p++; return '\v';
+	}
+	if (addShorthand(bits, c)) {
+		ps.p++;
+		return SHORTHAND;
+	}
+	if (c >= '0' && c <= '9') {
+		fail(ps, "backreferences are not supported");
+		return PARSE_ERROR;
+	}
+	if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+		fail(ps, "unknown escape");
+		return PARSE_ERROR;
+	}
+	ps.p++;
+	return static_cast<unsigned char>(c);
+}
+
+static int	parseClassItem(PatternParser& ps, uint32_t* bits) {
+	if (*ps.p == '\\') {
+		ps.p++;
+		return parseEscape(ps, bits);
+	}
+	return static_cast<unsigned char>(*ps.p++);
+}
+
+// Just after '['; a ']' right after '[' or '[^' is a literal.
+static bool	parseClass(PatternParser& ps, uint32_t* bits) {
+	bool negate = ps.p < ps.end && *ps.p == '^';
+	bool first = true;
+
+	if (negate)
+		ps.p++;
+	while (ps.p < ps.end && (first || *ps.p != ']')) {
+		int lo = parseClassItem(ps, bits);
+		int hi = lo;
+
+		first = false;
+		if (lo == PARSE_ERROR)
+			return false;
+		if (lo >= 0 && ps.p + 1 < ps.end && *ps.p == '-' && ps.p[1] != ']') {
+			ps.p++;
+			hi = parseClassItem(ps, bits);
+			if (hi == PARSE_ERROR)
+				return false;
+			if (hi < lo) {
+				fail(ps, "bad class range");
+				return false;
+			}
+		}
+		if (lo >= 0)
+			addRange(bits, lo, hi);
+	}
+	if (ps.p == ps.end) {
+		fail(ps, "missing ]");
+		return false;
+	}
+	ps.p++;
+	if (negate)
+		invert(bits);
+	return true;
+}
+
+static PatternNode*	parseGroup(PatternParser& ps) {
+	int group = -1;
+
+	if (ps.p + 1 < ps.end && ps.p[0] == '?' && ps.p[1] == ':')
+		ps.p += 2;
+	else
+		group = ++ps.groups;
+
+	PatternNode* body = parseAlternate(ps);
+	if (!body)
+		return NULL;
+	if (ps.p == ps.end || *ps.p != ')') {
+		fail(ps, "missing )");
+		PatternProgram::freeTree(body);
+		return NULL;
+	}
+	ps.p++;
+	if (group < 0)
+		return body;
+
+	PatternNode* node = newNode(PatternNode::GROUP);
+	node->group = group;
+	node->child = body;
+	return node;
+}
+
+static PatternNode*	parseAtom(PatternParser& ps) {
+	char c = *ps.p;
+
+	if (c == '*' || c == '+' || c == '?') {
+		fail(ps, "nothing to repeat");
+		return NULL;
+	}
+	if (c == '^' || c == '$') {
+		fail(ps, "anchors are not supported");
+		return NULL;
+	}
+	ps.p++;
+	if (c == '(')
+		return parseGroup(ps);
+
+	PatternNode*	node = newNode(PatternNode::BYTES);
+	bool			ok = true;
+
+	if (c == '[')
+		ok = parseClass(ps, node->bits);
+	else if (c == '.') {
+		addRange(node->bits, 0, 255);
+		node->bits['\n' >> 5] &= ~(1u << ('\n' & 31));
+	}
+	else if (c == '\\') {
+		int byte = parseEscape(ps, node->bits);
+		ok = byte != PARSE_ERROR;
+		if (byte >= 0)
+			addRange(node->bits, byte, byte);
+	}
+	else
+		addRange(node->bits, static_cast<unsigned char>(c), static_cast<unsigned char>(c));
+	if (!ok) {
+		delete node;
+		return NULL;
+	}
+	return node;
+}
+
+static int	parseNumber(PatternParser& ps) {
+	int value = 0;
+
+	while (ps.p < ps.end && *ps.p >= '0' && *ps.p <= '9') {
+		if (value <= PatternProgram::MAX_REPEAT)
+			value = value * 10 + (*ps.p - '0');
+		ps.p++;
+	}
+	return value;
+}
+
+/*
+** At a '{': 1 with min/max set (max -1 when unbounded), 0 when the brace is
+** not a bound (left for parseAtom as a literal), -1 on error.
+*/
+static int	parseBound(PatternParser& ps, int& min, int& max) {
+	if (ps.p + 1 >= ps.end || ps.p[1] < '0' || ps.p[1] > '9')
+		return 0;
+	ps.p++;
+	min = parseNumber(ps);
+	max = min;
+	if (ps.p < ps.end && *ps.p == ',') {
+		ps.p++;
+		max = -1;
+		if (ps.p < ps.end && *ps.p >= '0' && *ps.p <= '9')
+			max = parseNumber(ps);
+	}
+	if (ps.p == ps.end || *ps.p != '}') {
+		fail(ps, "missing }");
+		return -1;
+	}
+	if (min > PatternProgram::MAX_REPEAT || max > PatternProgram::MAX_REPEAT) {
+		fail(ps, "repetition count too large");
+		return -1;
+	}
+	if (max >= 0 && max < min) {
+		fail(ps, "bad repetition range");
+		return -1;
+	}
+	ps.p++;
+	return 1;
+}
+
+static PatternNode*	parseRepeat(PatternParser& ps) {
+	PatternNode* atom = parseAtom(ps);
+
+	while (atom && ps.p < ps.end) {
+		int min = 0;
+		int max = -1;
+
+		if (*ps.p == '*' || *ps.p == '+' || *ps.p == '?') {
+			min = *ps.p == '+';
+			max = *ps.p == '?' ? 1 : -1;
+			ps.p++;
+		}
+		else if (*ps.p == '{') {
+			int bound = parseBound(ps, min, max);
+			if (bound == 0)
+				break;
+			if (bound < 0) {
+				PatternProgram::freeTree(atom);
+				return NULL;
+			}
+		}
+		else
+			break;
+
+		PatternNode* repeat = newNode(PatternNode::REPEAT);
+		repeat->child = atom;
+		repeat->min = min;
+		repeat->max = max;
+		atom = repeat;
+	}
+	return atom;
+}
+
+static PatternNode*	parseConcat(PatternParser& ps) {
+	PatternNode* concat = newNode(PatternNode::CONCAT);
+	PatternNode* last = NULL;
+
+	while (ps.p < ps.end && *ps.p != '|' && *ps.p != ')') {
+		PatternNode* item = parseRepeat(ps);
+		if (!item) {
+			PatternProgram::freeTree(concat);
+			return NULL;
+		}
+		if (last)
+			last->next = item;
+		else
+			concat->child = item;
+		last = item;
+	}
+	if (!concat->child)
+		concat->type = PatternNode::EMPTY;
+	else if (!concat->child->next) {
+		PatternNode* only = concat->child;
+		delete concat;
+		return only;
+	}
+	return concat;
+}
+
+static PatternNode*	parseAlternate(PatternParser& ps) {
+	PatternNode* first = parseConcat(ps);
+
+	if (!first || ps.p == ps.end || *ps.p != '|')
+		return first;
+
+	PatternNode* alternate = newNode(PatternNode::ALTERNATE);
+	PatternNode* last = first;
+
+	alternate->child = first;
+	while (ps.p < ps.end && *ps.p == '|') {
+		ps.p++;
+		PatternNode* branch = parseConcat(ps);
+		if (!branch) {
+			PatternProgram::freeTree(alternate);
+			return NULL;
+		}
+		last->next = branch;
+		last = branch;
+	}
+	return alternate;
+}
+
+PatternNode*	PatternProgram::parse(std::string const& pattern, int& groups, std::string& error) {
+	PatternParser ps;
+
+	ps.begin = pattern.data();
+	ps.p = ps.begin;
+	ps.end = ps.begin + pattern.size();
+	ps.groups = 0;
+
+	PatternNode* tree = parseAlternate(ps);
+	if (tree && ps.p != ps.end) {
+		fail(ps, "unmatched )");
+		freeTree(tree);
+		tree = NULL;
+	}
+	groups = ps.groups;
+	error = ps.error;
+	return tree;
+};
+
+void	PatternProgram::freeTree(PatternNode* node) {
+	while (node) {
+		PatternNode* next = node->next;
+		freeTree(node->child);
+		delete node;
+		node = next;
+	}
+};
+
+PatternProgram::PatternProgram()
+	: _insts(NULL), _count(0), _capacity(0), _start(0), _groups(0), _overflow(false), _classCount(1) {
+	std::memset(_classOf, 0, sizeof(_classOf));
+	std::memset(_classRep, 0, sizeof(_classRep));
+};
+
+PatternProgram::PatternProgram(PatternProgram const& src)
+	: _insts(NULL), _count(0), _capacity(0) {
+	*this = src;
+};
+
+PatternProgram& PatternProgram::operator=(PatternProgram const& rhs) {
+	if (this != &rhs) {
+		delete[] _insts;
+		_insts = NULL;
+		_capacity = rhs._count;
+		if (_capacity)
+			_insts = new PatternInst[_capacity];
+		for (_count = 0; _count < rhs._count; _count++)
+			_insts[_count] = rhs._insts[_count];
+		_start = rhs._start;
+		_groups = rhs._groups;
+		_overflow = rhs._overflow;
+		std::memcpy(_classOf, rhs._classOf, sizeof(_classOf));
+		std::memcpy(_classRep, rhs._classRep, sizeof(_classRep));
+		_classCount = rhs._classCount;
+	}
+	return *this;
+};
+
+PatternProgram::~PatternProgram() {
+	delete[] _insts;
+};
+
+// Past MAX_INSTS only the overflow flag is set; build() then fails.
+int	PatternProgram::addInst(int op, int arg, int out, int out1) {
+	if (_count == MAX_INSTS) {
+		_overflow = true;
+		return 0;
+	}
+	if (_count == _capacity) {
+		_capacity = _capacity ? _capacity * 2 : 64;
+		PatternInst* grown = new PatternInst[_capacity];
+		for (int i = 0; i < _count; i++)
+			grown[i] = _insts[i];
+		delete[] _insts;
+		_insts = grown;
+	}
+	PatternInst& inst = _insts[_count];
+	inst.op = op;
+	inst.arg = arg;
+	inst.out = out;
+	inst.out1 = out1;
+	std::memset(inst.bits, 0, sizeof(inst.bits));
+	return _count++;
+};
+
+/*
+** Compiles node so that it continues at next and returns its entry point.
+** Building back to front needs no patch lists: every successor exists
+** before the instruction that jumps to it, loops aside.
+*/
+int	PatternProgram::emit(PatternNode const* node, int next, bool reversed) {
+	switch (node->type) {
+		case PatternNode::BYTES: {
+			int i = addInst(PatternInst::BYTES, 0, next, -1);
+			std::memcpy(_insts[i].bits, node->bits, sizeof(node->bits));
+			return i;
+		}
+		case PatternNode::CONCAT:
+			if (!reversed)
+				return emitList(node->child, next, false);
+			for (PatternNode const* child = node->child; child; child = child->next)
+				next = emit(child, next, true);
+			return next;
+		case PatternNode::ALTERNATE:
+			return emitAlternate(node->child, next, reversed);
+		case PatternNode::GROUP:
+			if (reversed)
+				return emit(node->child, next, true);
+			next = addInst(PatternInst::SAVE, 2 * node->group + 1, next, -1);
+			next = emit(node->child, next, false);
+			return addInst(PatternInst::SAVE, 2 * node->group, next, -1);
+		case PatternNode::REPEAT: {
+			int cur = next;
+			if (node->max < 0) {
+				int loop = addInst(PatternInst::SPLIT, 0, -1, next);
+				int body = emit(node->child, loop, reversed);
+				_insts[loop].out = body;
+				cur = loop;
+			}
+			// x{n,m}: n copies, then m - n nested optional copies.
+			for (int k = node->min; k < node->max && !_overflow; k++)
+				cur = addInst(PatternInst::SPLIT, 0, emit(node->child, cur, reversed), next);
+			for (int k = 0; k < node->min && !_overflow; k++)
+				cur = emit(node->child, cur, reversed);
+			return cur;
+		}
+	}
+	return next;
+};
+
+int	PatternProgram::emitList(PatternNode const* node, int next, bool reversed) {
+	if (!node)
+		return next;
+	return emit(node, emitList(node->next, next, reversed), reversed);
+};
+
+// Earlier branches get the preferred side of each SPLIT.
+int	PatternProgram::emitAlternate(PatternNode const* node, int next, bool reversed) {
+	if (!node->next)
+		return emit(node, next, reversed);
+
+	int first = emit(node, next, reversed);
+	int rest = emitAlternate(node->next, next, reversed);
+	return addInst(PatternInst::SPLIT, 0, first, rest);
+};
+
+bool	PatternProgram::build(PatternNode const* tree, int groups, bool reversed, std::string& error) {
+	_count = 0;
+	_groups = groups;
+	_overflow = false;
+
+	int next = addInst(PatternInst::MATCH, 0, -1, -1);
+	if (!reversed)
+		next = addInst(PatternInst::SAVE, 1, next, -1);
+	next = emit(tree, next, reversed);
+	if (!reversed)
+		next = addInst(PatternInst::SAVE, 0, next, -1);
+	_start = next;
+	if (_overflow) {
+		error = "pattern too large once repetitions are expanded";
+		return false;
+	}
+	computeClasses();
+	return true;
+};
+
+// Bytes no instruction tells apart share a class, so the DFA keeps one
+// transition per class instead of 256 per state.
+void	PatternProgram::computeClasses() {
+	bool boundary[256];
+
+	std::memset(boundary, 0, sizeof(boundary));
+	for (int i = 0; i < _count; i++) {
+		if (_insts[i].op != PatternInst::BYTES)
+			continue;
+		for (int c = 1; c < 256; c++) {
+			if (hasByte(_insts[i].bits, c) != hasByte(_insts[i].bits, c - 1))
+				boundary[c] = true;
+		}
+	}
+	_classCount = 1;
+	_classOf[0] = 0;
+	_classRep[0] = 0;
+	for (int c = 1; c < 256; c++) {
+		if (boundary[c])
+			_classRep[_classCount++] = c;
+		_classOf[c] = _classCount - 1;
+	}
+};
+
+PatternInst const*	PatternProgram::insts() const {
+	return _insts;
+};
+
+int	PatternProgram::size() const {
+	return _count;
+};
+
+int	PatternProgram::start() const {
+	return _start;
+};
+
+int	PatternProgram::groups() const {
+	return _groups;
+};
+
+unsigned char const*	PatternProgram::classOf() const {
+	return _classOf;
+};
+
+unsigned char const*	PatternProgram::classRep() const {
+	return _classRep;
+};
+
+int	PatternProgram::classCount() const {
+	return _classCount;
+};
+
+// Whether MATCH is reachable from the start without reading a byte.
+bool	PatternProgram::matchesEmpty() const {
+	bool*	seen = new bool[_count]();
+	int*	stack = new int[_count];
+	int		top = 0;
+	bool	found = false;
+
+	stack[top++] = _start;
+	seen[_start] = true;
+	while (top && !found) {
+		PatternInst const& inst = _insts[stack[--top]];
+		int outs[2] = {-1, -1};
+
+		if (inst.op == PatternInst::MATCH)
+			found = true;
+		else if (inst.op == PatternInst::SPLIT) {
+			outs[0] = inst.out;
+			outs[1] = inst.out1;
+		}
+		else if (inst.op == PatternInst::SAVE)
+			outs[0] = inst.out;
+		for (int k = 0; k < 2; k++) {
+			if (outs[k] >= 0 && !seen[outs[k]]) {
+				seen[outs[k]] = true;
+				stack[top++] = outs[k];
+			}
+		}
+	}
+	delete[] seen;
+	delete[] stack;
+	return found;
+};
+
+bool	PatternProgram::hasByte(uint32_t const* bits, unsigned char c) {
+	return (bits[c >> 5] >> (c & 31)) & 1;
+};
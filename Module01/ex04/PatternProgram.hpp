@@ -0,0 +1,86 @@
+#ifndef PATTERNPROGRAM_HPP
+# define PATTERNPROGRAM_HPP
+# include <string>
+# include <cstddef>
+# include <stdint.h>
+
+/*
+** Regex subset accepted by the -E mode of the replacer:
+**   literals, `.` (any byte but '\n'), classes `[a-z_]` / `[^...]`,
+**   escapes \d \w \s (\D \W \S), \n \t \r and escaped punctuation,
+**   groups `(...)` (captured) and `(?:...)`, alternation `|`,
+**   repetition `*` `+` `?` `{n}` `{n,}` `{n,m}`.
+** No anchors or backreferences: every pattern stays a regular language.
+**
+** The pattern is parsed once into a PatternNode tree, then compiled into a
+** Thompson NFA (PatternInst array) either forward or reversed. The reversed
+** program reads the text backwards and carries no SAVE instructions.
+*/
+
+struct PatternNode {
+	enum Type { BYTES, CONCAT, ALTERNATE, REPEAT, GROUP, EMPTY };
+
+	int				type;
+	uint32_t		bits[8];
+	int				min;
+	int				max;
+	int				group;
+	PatternNode*	child;
+	PatternNode*	next;
+};
+
+struct PatternInst {
+	enum Op { BYTES, SPLIT, SAVE, MATCH };
+
+	int			op;
+	int			arg;
+	int			out;
+	int			out1;
+	uint32_t	bits[8];
+};
+
+class PatternProgram {
+	private:
+		PatternInst*	_insts;
+		int				_count;
+		int				_capacity;
+		int				_start;
+		int				_groups;
+		bool			_overflow;
+		unsigned char	_classOf[256];
+		unsigned char	_classRep[256];
+		int				_classCount;
+
+		int		addInst(int op, int arg, int out, int out1);
+		int		emit(PatternNode const* node, int next, bool reversed);
+		int		emitList(PatternNode const* node, int next, bool reversed);
+		int		emitAlternate(PatternNode const* node, int next, bool reversed);
+		void	computeClasses();
+
+	public:
+		static const int	MAX_INSTS = 1 << 16;
+		static const int	MAX_REPEAT = 1000;
+
+		PatternProgram();
+		PatternProgram(PatternProgram const& src);
+		PatternProgram& operator=(PatternProgram const& rhs);
+		~PatternProgram();
+
+		static PatternNode*	parse(std::string const& pattern, int& groups, std::string& error);
+		static void			freeTree(PatternNode* node);
+
+		bool	build(PatternNode const* tree, int groups, bool reversed, std::string& error);
+
+		PatternInst const*		insts() const;
+		int						size() const;
+		int						start() const;
+		int						groups() const;
+		unsigned char const*	classOf() const;
+		unsigned char const*	classRep() const;
+		int						classCount() const;
+		bool					matchesEmpty() const;
+
+		static bool	hasByte(uint32_t const* bits, unsigned char c);
+};
+
+#endif
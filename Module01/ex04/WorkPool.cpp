@@ -0,0 +1,114 @@
+#include "WorkPool.hpp"
+#include <pthread.h>
+
+// The remaining slice [head, tail) of one worker, on its own cache line.
+struct WorkQueue {
+	pthread_mutex_t	lock;
+	size_t			head;
+	size_t			tail;
+	char			pad[64];
+};
+
+struct WorkShared {
+	WorkQueue*		queues;
+	unsigned		count;
+	WorkPool::Task	task;
+	void*			context;
+};
+
+struct WorkArg {
+	WorkShared*	shared;
+	unsigned	id;
+};
+
+static bool	popOwn(WorkQueue& queue, size_t& index) {
+	bool found;
+
+	pthread_mutex_lock(&queue.lock);
+	found = queue.head < queue.tail;
+	if (found)
+		index = --queue.tail;
+	pthread_mutex_unlock(&queue.lock);
+	return found;
+}
+
+/*
+** Takes the front half of the first non-empty queue after id: its first
+** index is returned, the rest becomes the thief's own slice. Indices are
+** never added back, so a full round of empty queues means all are taken.
+*/
+static bool	steal(WorkShared& shared, unsigned id, size_t& index) {
+	for (unsigned k = 1; k < shared.count; k++) {
+		WorkQueue&	victim = shared.queues[(id + k) % shared.count];
+		size_t		begin;
+		size_t		end;
+
+		pthread_mutex_lock(&victim.lock);
+		begin = victim.head;
+		end = begin + (victim.tail - begin + 1) / 2;
+		victim.head = end;
+		pthread_mutex_unlock(&victim.lock);
+		if (begin == end)
+			continue;
+
+		WorkQueue& own = shared.queues[id];
+		pthread_mutex_lock(&own.lock);
+		own.head = begin + 1;
+		own.tail = end;
+		pthread_mutex_unlock(&own.lock);
+		index = begin;
+		return true;
+	}
+	return false;
+}
+
+static void*	workLoop(void* arg) {
+	WorkArg*	work = static_cast<WorkArg*>(arg);
+	WorkShared&	shared = *work->shared;
+	size_t		index;
+
+	while (popOwn(shared.queues[work->id], index) || steal(shared, work->id, index))
+		shared.task(index, work->id, shared.context);
+	return NULL;
+}
+
+// Threads run() will use for count tasks: at least 1, at most MAX_THREADS and count.
+unsigned	WorkPool::workerCount(size_t count, unsigned threads) {
+	if (threads > MAX_THREADS)
+		threads = MAX_THREADS;
+	if (threads > count)
+		threads = static_cast<unsigned>(count);
+	return threads ? threads : 1;
+};
+
+// Returns once every index has been run exactly once.
+void	WorkPool::run(size_t count, unsigned threads, Task task, void* context) {
+	unsigned	workers = workerCount(count, threads);
+	WorkQueue	queues[MAX_THREADS];
+	WorkArg		args[MAX_THREADS];
+	pthread_t	ids[MAX_THREADS];
+	bool		started[MAX_THREADS];
+	WorkShared	shared;
+
+	shared.queues = queues;
+	shared.count = workers;
+	shared.task = task;
+	shared.context = context;
+	for (unsigned w = 0; w < workers; w++) {
+		pthread_mutex_init(&queues[w].lock, NULL);
+		queues[w].head = count * w / workers;
+		queues[w].tail = count * (w + 1) / workers;
+		args[w].shared = &shared;
+		args[w].id = w;
+	}
+	// A worker that fails to start leaves its slice to be stolen.
+	for (unsigned w = 1; w < workers; w++)
+		started[w] = pthread_create(&ids[w], NULL, workLoop, &args[w]) == 0;
+	workLoop(&args[0]);
+	for (unsigned w = 1; w < workers; w++) {
+		if (started[w])
+			pthread_join(ids[w], NULL);
+	}
+	for (unsigned w = 0; w < workers; w++)
+		pthread_mutex_destroy(&queues[w].lock);
+};
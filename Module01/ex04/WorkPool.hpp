@@ -0,0 +1,25 @@
+#ifndef WORKPOOL_HPP
+# define WORKPOOL_HPP
+# include <cstddef>
+
+/*
+** Work-stealing pool over the task indices [0, count). Each worker starts
+** with a contiguous slice and pops from its back; a worker that runs dry
+** steals the front half of another worker's remaining slice, so a few slow
+** items (large files) do not leave the other threads idle. Tasks get their
+** worker number to index per-worker state; worker 0 is the calling thread.
+*/
+class WorkPool {
+	private:
+		WorkPool();
+
+	public:
+		typedef void	(*Task)(size_t index, unsigned worker, void* context);
+
+		static const unsigned	MAX_THREADS = 64;
+
+		static unsigned	workerCount(size_t count, unsigned threads);
+		static void		run(size_t count, unsigned threads, Task task, void* context);
+};
+
+#endif
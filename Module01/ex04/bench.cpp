@@ -0,0 +1,154 @@
+#include "FileHandler.hpp"
+#include "BatchReplacer.hpp"
+#include "Bench.hpp"
+#include <cstdio>
+#include <sstream>
+#include <sys/stat.h>
+
+/*
+** Replace pipeline on a generated LINES-line file, each stage timed on its
+** own; per-byte numbers are against the input size. The -E pattern mode is
+** timed on replaceOccurence() alone, against the literal search above.
+** Batch mode is timed end to end over BATCH_FILES small files, against a
+** FileHandler per file (what one process per file does, minus the start),
+** with io_uring and with the pread/pwrite fallback.
+*/
+static const int	LINES = 1 << 18;
+static const int	ROUNDS = 8;
+static char const*	INPUT = "bench_input.txt";
+static char const*	OUTPUT = "bench_input.txt.replace";
+static const int	BATCH_FILES = 4096;
+static const int	BATCH_LINES = 64;
+static char const*	BATCH_DIR = "bench_batch";
+
+static void	benchPattern(char const* name, char const* pattern, char const* replaceStr, double bytes) {
+	unsigned long long	elapsed = 0;
+	long				produced = 0;
+
+	for (int r = 0; r < ROUNDS; r++) {
+		FileHandler handler(OUTPUT);
+
+		handler.setFileContent(INPUT);
+		handler.setOccurence(pattern);
+		handler.setReplaceStr(replaceStr);
+		if (!handler.usePattern())
+			return;
+
+		unsigned long long start = Bench::now();
+		handler.replaceOccurence();
+		elapsed += Bench::now() - start;
+		produced += handler.getOutputFileContent().size();
+	}
+	Bench::reportElapsed("FileHandler", name, elapsed, bytes * ROUNDS, "byte", produced);
+}
+
+static std::string	batchPath(int i) {
+	std::ostringstream os;
+
+	os << BATCH_DIR << "/file" << i << ".txt";
+	return os.str();
+}
+
+// Outputs of the previous run are removed first: overwriting costs more than creating.
+static void	benchBatch(char const* name, unsigned threads, bool ringIo, double bytes) {
+	BatchReplacer batch;
+
+	for (int i = 0; i < BATCH_FILES; i++)
+		std::remove((batchPath(i) + ".replace").c_str());
+	batch.setRingIo(ringIo);
+	batch.setOccurence("fox");
+	batch.setReplaceStr("wolf");
+	batch.addSource(BATCH_DIR);
+
+	unsigned long long start = Bench::now();
+	batch.run(threads);
+	Bench::report("BatchReplacer", name, start, bytes, "byte",
+		static_cast<long>(batch.getBytesWritten()));
+}
+
+static void	benchFiles(void) {
+	double	bytes = 0;
+	long	produced = 0;
+
+	mkdir(BATCH_DIR, 0755);
+	for (int i = 0; i < BATCH_FILES; i++) {
+		std::ofstream file(batchPath(i).c_str());
+
+		for (int l = 0; l < BATCH_LINES; l++)
+			file << "file " << i << " line " << l << ": the quick brown fox jumps over the lazy dog\n";
+		bytes += static_cast<double>(file.tellp());
+	}
+
+	unsigned long long start = Bench::now();
+	for (int i = 0; i < BATCH_FILES; i++) {
+		std::string			path = batchPath(i);
+		FileHandler			handler(path + ".replace");
+
+		handler.setFileContent(path);
+		handler.setOccurence("fox");
+		handler.setReplaceStr("wolf");
+		handler.replaceOccurence();
+		handler.exportFileContent();
+		produced += handler.getOutputFileContent().size();
+	}
+	Bench::report("BatchReplacer", "FileHandler per file", start, bytes, "byte", produced);
+	benchBatch("run, 1 thread", 1, true, bytes);
+	benchBatch("run, default threads", 0, true, bytes);
+	benchBatch("run, 1 thread, pread/pwrite", 1, false, bytes);
+	benchBatch("run, default, pread/pwrite", 0, false, bytes);
+
+	for (int i = 0; i < BATCH_FILES; i++) {
+		std::remove(batchPath(i).c_str());
+		std::remove((batchPath(i) + ".replace").c_str());
+	}
+	std::remove(BATCH_DIR);
+}
+
+int	main(void) {
+	std::ofstream	input(INPUT);
+	double			bytes;
+	long			produced = 0;
+
+	for (int i = 0; i < LINES; i++)
+		input << "line " << i << ": 2026-10-19 12:" << i % 60 << ":" << i % 61
+			<< " from 10." << i % 256 << "." << (i >> 8) % 256 << "." << i % 199
+			<< " the quick brown fox jumps over the lazy dog, fox again\n";
+	bytes = static_cast<double>(input.tellp());
+	input.close();
+
+	unsigned long long	readTime = 0;
+	unsigned long long	replaceTime = 0;
+	unsigned long long	exportTime = 0;
+	for (int r = 0; r < ROUNDS; r++) {
+		FileHandler			handler(OUTPUT);
+		unsigned long long	start = Bench::now();
+
+		handler.setFileContent(INPUT);
+		readTime += Bench::now() - start;
+		handler.setOccurence("fox");
+		handler.setReplaceStr("wolf");
+		start = Bench::now();
+		handler.replaceOccurence();
+		replaceTime += Bench::now() - start;
+		start = Bench::now();
+		handler.exportFileContent();
+		exportTime += Bench::now() - start;
+		produced += handler.getOutputFileContent().size();
+	}
+
+	Bench::reportElapsed("FileHandler", "setFileContent", readTime,
+		bytes * ROUNDS, "byte", produced);
+	Bench::reportElapsed("FileHandler", "replaceOccurence", replaceTime,
+		bytes * ROUNDS, "byte", produced);
+	Bench::reportElapsed("FileHandler", "exportFileContent", exportTime,
+		bytes * ROUNDS, "byte", produced);
+	benchPattern("-E fox (literal pattern)", "fox", "wolf", bytes);
+	benchPattern("-E date", "\\d{4}-\\d\\d-\\d\\d", "DATE", bytes);
+	benchPattern("-E IPv4 with groups", "([0-9]{1,3})\\.([0-9]{1,3})\\.[0-9]{1,3}\\.[0-9]{1,3}",
+		"\\1.\\2.x.x", bytes);
+	benchPattern("-E fox|dog|cat", "fox|dog|cat", "animal", bytes);
+	std::remove(INPUT);
+	std::remove(OUTPUT);
+	benchFiles();
+	return 0;
+}
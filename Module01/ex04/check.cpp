@@ -0,0 +1,400 @@
+#include "BatchReplacer.hpp"
+#include "FileHandler.hpp"
+#include "Pattern.hpp"
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+** Pattern (-E mode) against expected outputs: fixed cases for the matching
+** rules, the replacement syntax and the refused patterns, then random
+** patterns against a brute-force reference (NFA set simulation from every
+** start), a text that overflows the DFA cache, and a pattern whose scans
+** run far past their matches, which must stay linear. Batch mode (-b) runs
+** over a generated tree, with io_uring and with pread/pwrite, and has to
+** write what single-file mode writes. Prints one line per check, exits 1 on
+** any failure.
+*/
+
+struct Case {
+	char const*	pattern;
+	char const*	replacement;
+	char const*	input;
+	char const*	expected;	// NULL: compile() must fail with error
+	char const*	error;
+};
+
+static const Case	CASES[] = {
+	// leftmost, then longest whatever the alternative order
+	{"a|ab", "X", "abab", "XX", NULL},
+	{"ab|a", "X", "aab", "XX", NULL},
+	{"aba", "X", "ababa", "Xba", NULL},
+	{".+", "X", "ab\ncd", "X\nX", NULL},
+	{"[^a]+", "_", "aabba", "aa_a", NULL},
+	{"x{2}", "-", "xxxxx", "--x", NULL},
+	{"x{2,3}", "-", "xxxxxxx", "--x", NULL},
+	{"x{2,}", "-", "xxxxx.xx", "-.-", NULL},
+	{"(?:ab){1,2}c", "-", "abcababcabababc", "--ab-", NULL},
+	// groups: earlier alternatives and longer repetitions first
+	{"(a|ab)(c|bcd)", "[\\1,\\2]", "abcd", "[a,bcd]", NULL},
+	{"(a*)(a+)", "[\\1,\\2]", "aaa", "[aa,a]", NULL},
+	{"(\\d+)-(\\d+)", "\\2-\\1", "10-20 3-4", "20-10 4-3", NULL},
+	{"(x)?y", "<\\1>", "y xy", "<> <x>", NULL},
+	{"(a)(b)(c)(d)(e)(f)(g)(h)(i)", "\\9\\1", "abcdefghi", "ia", NULL},
+	{"b", "\\\\|\\n|\\t|\\0|\\q", "abc", "a\\|\n|\t|b|qc", NULL},
+	// refused
+	{"^a", "X", "", NULL, "anchors are not supported"},
+	{"a$", "X", "", NULL, "anchors are not supported"},
+	{"a*", "X", "", NULL, "pattern can match an empty string"},
+	{"(a|b?)", "X", "", NULL, "pattern can match an empty string"},
+	{"", "X", "", NULL, "empty pattern"},
+	{"(a)", "\\2", "", NULL, "replacement refers to group 2"},
+	{"a\\1", "X", "", NULL, "backreferences are not supported"},
+	{"(ab", "X", "", NULL, "missing )"},
+};
+
+static int	failures = 0;
+
+static void	result(bool ok, std::string const& what) {
+	std::cout << (ok ? "ok   " : "FAIL ") << what << std::endl;
+	if (!ok)
+		failures++;
+}
+
+static void	checkCases(void) {
+	int count = sizeof(CASES) / sizeof(CASES[0]);
+
+	for (int i = 0; i < count; i++) {
+		Case const&	c = CASES[i];
+		Pattern		pattern;
+		std::string	output;
+		bool		compiled = pattern.compile(c.pattern, c.replacement);
+		bool		ok;
+
+		if (c.expected) {
+			if (compiled)
+				pattern.replaceAll(c.input, output);
+			ok = compiled && output == c.expected;
+		}
+		else
+			ok = !compiled && pattern.getError().find(c.error) == 0;
+		if (!ok) {
+			std::cout << "     " << c.pattern << " -> " << (compiled ? output : pattern.getError())
+				<< std::endl;
+		}
+		result(ok, std::string(c.pattern) + (c.expected ? " on \"" + std::string(c.input) + "\""
+			: " refused: " + std::string(c.error)));
+	}
+}
+
+// Every instruction reachable from pc without reading a byte.
+static void	addClosure(PatternInst const* insts, int pc, unsigned char* set) {
+	if (set[pc])
+		return;
+	set[pc] = 1;
+	if (insts[pc].op == PatternInst::SPLIT) {
+		addClosure(insts, insts[pc].out, set);
+		addClosure(insts, insts[pc].out1, set);
+	}
+	else if (insts[pc].op == PatternInst::SAVE)
+		addClosure(insts, insts[pc].out, set);
+}
+
+// End of the longest match at begin by set simulation, begin when none.
+static size_t	referenceMatch(PatternProgram const& program, std::string const& text, size_t begin) {
+	PatternInst const*	insts = program.insts();
+	int					size = program.size();
+	unsigned char*		set = new unsigned char[size]();
+	unsigned char*		next = new unsigned char[size];
+	size_t				last = begin;
+	bool				alive = true;
+
+	addClosure(insts, program.start(), set);
+	for (size_t pos = begin; alive; pos++) {
+		alive = false;
+		for (int pc = 0; pc < size; pc++) {
+			if (set[pc] && insts[pc].op == PatternInst::MATCH)
+				last = pos;
+		}
+		if (pos == text.size())
+			break;
+		for (int pc = 0; pc < size; pc++)
+			next[pc] = 0;
+		for (int pc = 0; pc < size; pc++) {
+			if (set[pc] && insts[pc].op == PatternInst::BYTES
+				&& PatternProgram::hasByte(insts[pc].bits, text[pos])) {
+				addClosure(insts, insts[pc].out, next);
+				alive = true;
+			}
+		}
+		for (int pc = 0; pc < size; pc++)
+			set[pc] = next[pc];
+	}
+	delete[] set;
+	delete[] next;
+	return last;
+}
+
+// Every leftmost-longest match wrapped in <>, matches never overlapping.
+static std::string	referenceReplace(std::string const& pattern, std::string const& text) {
+	int				groups = 0;
+	std::string		error;
+	PatternProgram	program;
+	PatternNode*	tree = PatternProgram::parse(pattern, groups, error);
+	std::string		output;
+
+	program.build(tree, groups, false, error);
+	PatternProgram::freeTree(tree);
+	for (size_t pos = 0; pos < text.size();) {
+		size_t end = referenceMatch(program, text, pos);
+
+		if (end == pos)
+			output += text[pos++];
+		else {
+			output += "<" + text.substr(pos, end - pos) + ">";
+			pos = end;
+		}
+	}
+	return output;
+}
+
+static unsigned	g_seed = 12345;
+
+static unsigned	nextRandom(unsigned range) {
+	g_seed = g_seed * 1664525u + 1013904223u;
+	return (g_seed >> 8) % range;
+}
+
+static std::string	randomPattern(int depth);
+
+static std::string	randomAtom(int depth) {
+	static char const*	atoms[] = {"a", "b", "c", "[ab]", ".", "[^a]", "\\s"};
+	unsigned			kind = nextRandom(10);
+
+	if (depth > 2 || kind < 5)
+		return atoms[nextRandom(7)];
+	if (kind < 7)
+		return "(" + randomPattern(depth + 1) + ")";
+	return "(" + randomPattern(depth + 1) + "|" + randomPattern(depth + 1) + ")";
+}
+
+static std::string	randomPattern(int depth) {
+	static char const*	repeats[] = {"*", "+", "?", "{2}", "{0,2}", "{1,3}", "{2,}"};
+	std::string			pattern;
+
+	for (unsigned n = 1 + nextRandom(3); n > 0; n--) {
+		pattern += randomAtom(depth);
+		if (nextRandom(2))
+			pattern += repeats[nextRandom(7)];
+	}
+	return pattern;
+}
+
+static std::string	randomText(size_t length, char const* alphabet, unsigned size) {
+	std::string text;
+
+	for (size_t i = 0; i < length; i++)
+		text += alphabet[nextRandom(size)];
+	return text;
+}
+
+// Pattern and reference must agree; prints the first disagreement.
+static bool	agrees(std::string const& source, std::string const& text) {
+	Pattern		pattern;
+	std::string	output;
+
+	if (!pattern.compile(source, "<\\0>"))
+		return true;
+	pattern.replaceAll(text, output);
+	if (output == referenceReplace(source, text))
+		return true;
+	std::cout << "     " << source << " disagrees on \"" << text.substr(0, 60) << "...\"" << std::endl;
+	return false;
+}
+
+static void	checkRandom(void) {
+	int		compiled = 0;
+	bool	ok = true;
+
+	for (int i = 0; i < 3000 && ok; i++) {
+		std::string source = randomPattern(0);
+
+		if (nextRandom(4) == 0)
+			source += "|" + randomPattern(0);
+
+		Pattern probe;
+		if (probe.compile(source, "<\\0>"))
+			compiled++;
+		ok = agrees(source, randomText(nextRandom(600), "aabbc \n", 7));
+	}
+	std::ostringstream os;
+	os << "random patterns against the reference (" << compiled << " compiled)";
+	result(ok, os.str());
+}
+
+// Windows of the last 13 bytes are the states: more than MAX_STATES.
+static void	checkCacheFlush(void) {
+	char const*		source = "[ab]*a[ab]{12}c";
+	std::string		text = randomText(40000, "ababababababababababababababc", 29);
+	PatternProgram	program;
+	int				groups = 0;
+	std::string		error;
+	PatternNode*	tree = PatternProgram::parse(source, groups, error);
+
+	program.build(tree, groups, false, error);
+	PatternProgram::freeTree(tree);
+
+	PatternDfa	dfa(program, false);
+	int			flushes = 0;
+	int			states = 0;
+	for (size_t pos = 0; pos < text.size(); pos += 7) {
+		dfa.longestMatch(text.data(), pos, text.size());
+		if (dfa.getStateCount() < states)
+			flushes++;
+		states = dfa.getStateCount();
+	}
+	std::ostringstream os;
+	os << source << " past the DFA cache (" << flushes << " flushes)";
+	result(flushes > 0 && agrees(source, text), os.str());
+}
+
+static double	replaceSeconds(char const* source, std::string const& text) {
+	Pattern		pattern;
+	std::string	output;
+	clock_t		start = clock();
+
+	pattern.compile(source, "X");
+	pattern.replaceAll(text, output);
+	return static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+}
+
+// Each scan of a*b|a runs to the end of the text: quadratic without reuse.
+static void	checkLinear(void) {
+	std::string	text(1 << 20, 'a');
+	double		plain = replaceSeconds("a", text);
+	double		overrun = replaceSeconds("a*b|a", text);
+
+	std::ostringstream os;
+	os << "a*b|a over 1 MiB of a: " << overrun << " s (a alone: " << plain << " s)";
+	result(overrun < 50 * plain + 0.05, os.str());
+}
+
+static char const*	BATCH_DIR = "check_batch";
+static const int	BATCH_FILES = 40;
+
+static std::string	batchPath(int i) {
+	std::ostringstream os;
+
+	os << BATCH_DIR << "/file" << i << ".txt";
+	return os.str();
+}
+
+static std::string	readWhole(std::string const& path) {
+	std::ifstream		file(path.c_str(), std::ios::binary);
+	std::ostringstream	os;
+
+	os << file.rdbuf();
+	return os.str();
+}
+
+static void	writeWhole(std::string const& path, std::string const& content) {
+	std::ofstream file(path.c_str(), std::ios::binary);
+
+	file << content;
+}
+
+// Small files, one empty, one of 300 KB, CRLF lines and a missing final newline.
+static void	makeBatchTree(void) {
+	mkdir(BATCH_DIR, 0755);
+	for (int i = 0; i < BATCH_FILES; i++) {
+		std::string text;
+
+		if (i == 7)
+			text = "";
+		else if (i == 11)
+			text = randomText(300000, "fox fooox\n", 11);
+		else if (i == 13)
+			text = "a fox\r\ntwo foxes\r\n";
+		else
+			text = randomText(nextRandom(2000), "fox fooox\n\r", 12);
+		writeWhole(batchPath(i), text);
+	}
+}
+
+static void	removeBatchTree(void) {
+	for (int i = 0; i < BATCH_FILES; i++) {
+		std::remove(batchPath(i).c_str());
+		std::remove((batchPath(i) + ".replace").c_str());
+	}
+	std::remove((std::string(BATCH_DIR) + "/list").c_str());
+	rmdir(BATCH_DIR);
+}
+
+// What single-file mode writes for path.
+static std::string	singleOutput(std::string const& path, char const* occurence,
+	char const* replaceStr, bool pattern) {
+	FileHandler handler(path + ".replace");
+
+	handler.setFileContent(path);
+	handler.setOccurence(occurence);
+	handler.setReplaceStr(replaceStr);
+	if (pattern)
+		handler.usePattern();
+	handler.replaceOccurence();
+	return handler.getOutputFileContent();
+}
+
+/*
+** The list ends one path with \r\n, has an empty line and a missing file:
+** exactly one failure, and every other output equal to single-file mode.
+*/
+static void	checkBatch(char const* occurence, char const* replaceStr, bool pattern, bool ringIo) {
+	std::string		list = std::string(BATCH_DIR) + "/list";
+	std::string		content;
+	BatchReplacer	batch;
+	size_t			failed;
+	int				wrong = 0;
+
+	for (int i = 0; i < BATCH_FILES; i++) {
+		content += batchPath(i) + (i == 5 ? "\r\n" : "\n");
+		if (i == 20)
+			content += "\n" + std::string(BATCH_DIR) + "/missing.txt\n";
+		std::remove((batchPath(i) + ".replace").c_str());
+	}
+	writeWhole(list, content);
+	batch.setRingIo(ringIo);
+	batch.setOccurence(occurence);
+	batch.setReplaceStr(replaceStr);
+	if (pattern)
+		batch.usePattern();
+	batch.addSource(list);
+	std::cout << "     (the missing file is expected to fail:)" << std::endl;
+	failed = batch.run(3);
+	for (int i = 0; i < BATCH_FILES; i++) {
+		if (readWhole(batchPath(i) + ".replace") != singleOutput(batchPath(i), occurence, replaceStr, pattern))
+			wrong++;
+	}
+
+	std::ostringstream os;
+	os << "-b" << (pattern ? " -E " : " ") << occurence << (ringIo ? " with io_uring" : " with pread/pwrite")
+		<< ": " << failed << " failed, " << wrong << " outputs differ from single-file mode";
+	result(failed == 1 && wrong == 0 && batch.getFileCount() == BATCH_FILES + 1, os.str());
+}
+
+int	main(void) {
+	checkCases();
+	checkRandom();
+	checkCacheFlush();
+	checkLinear();
+	makeBatchTree();
+	checkBatch("fox", "wolf", false, true);
+	checkBatch("fox", "wolf", false, false);
+	checkBatch("fo(o*)x", "[\\1]", true, true);
+	checkBatch("fo(o*)x", "[\\1]", true, false);
+	removeBatchTree();
+	return failures ? 1 : 0;
+}
@@ -1,7 +1,59 @@
 #include "FileHandler.hpp"
+#include "BatchReplacer.hpp"
+#include <sstream>
 
+// -b: every file of a list or directory in one process (see BatchReplacer.hpp)
+static int	runBatch(char const* source, char **av, bool pattern, unsigned threads)
+{
+	BatchReplacer batch;
+
+	batch.setOccurence(av[0]);
+	batch.setReplaceStr(av[1]);
+	if (pattern && !batch.usePattern())
+		return (1);
+	if (!batch.addSource(source))
+		return (1);
+	if (batch.run(threads))
+		return (1);
+	return (0);
+}
+
+/*
+** ./a.out [-E] <file> <s1> <s2>
+** ./a.out [-E] [-j threads] -b <list|directory> <s1> <s2>
+** With -E, s1 is a pattern (see Pattern.hpp).
+*/
 int main(int ac, char **av)
 {
+	bool		pattern = false;
+	char const*	batch = NULL;
+	unsigned	threads = 0;
+
+	for (; ac > 1; av++, ac--) {
+		std::string option(av[1]);
+
+		if (option == "-E")
+			pattern = true;
+		else if ((option == "-b" || option == "-j") && ac > 2) {
+			av++;
+			ac--;
+			if (option == "-b")
+				batch = av[1];
+			else if (!(std::istringstream(av[1]) >> threads) || threads == 0) {
+				std::cerr << "Error: Invalid thread count" << std::endl;
+				return (1);
+			}
+		}
+		else
+			break;
+	}
+	if (batch) {
+		if (ac != 3) {
+			std::cerr << "Error: Invalid number of arguments"<< std::endl;
+			return (1);
+		}
+		return runBatch(batch, av + 1, pattern, threads);
+	}
 	if (ac != 4) {
 		std::cerr << "Error: Invalid number of arguments"<< std::endl;
 		return (false);
@@ -15,8 +67,10 @@ int main(int ac, char **av)
 
 	fileHandler.setOccurence(av[2]);
 	fileHandler.setReplaceStr(av[3]);
+	if (pattern && !fileHandler.usePattern())
+		return (1);
 	fileHandler.replaceOccurence();
 	fileHandler.exportFileContent();
 
 	return (0);
-}
\ No newline at end of file
+}
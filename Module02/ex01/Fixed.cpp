@@ -11,7 +11,7 @@ Fixed::Fixed(): _fixedPoint(0) {
 
 Fixed::Fixed(int const num):_fixedPoint(num << _fractionalBits) {};
 
-Fixed::Fixed(float const num): _fixedPoint(roundf(num * 256)) {};
+Fixed::Fixed(float const num): _fixedPoint(floatToRaw(num)) {};
 
 Fixed::Fixed(Fixed const& src): _fixedPoint(src._fixedPoint) {
 	std::cout << "Copy constructor called\n";
@@ -2,6 +2,7 @@
 # define FIXED_HPP
 # include <iostream>
 # include <cmath>
+# include <cstddef>
 
 class Fixed {
 	private:
@@ -9,6 +10,19 @@ class Fixed {
 		static const int	_fractionalBits = 8;
 
 	public:
+		enum RoundMode {
+			ROUND_NEAREST_EVEN,
+			ROUND_NEAREST_AWAY,
+			ROUND_TRUNCATE,
+			ROUND_FLOOR
+		};
+		enum OverflowMode {
+			OVERFLOW_SATURATE,
+			OVERFLOW_WRAP
+		};
+
+		static const int	rawFractionalBits = _fractionalBits;
+
 		Fixed();
 		Fixed(int const num);
 		Fixed(float const num);
@@ -22,6 +36,44 @@ class Fixed {
 
 		int		toInt(void) const;
 		float	toFloat(void) const;
+
+		// IEEE-754 bit-level conversion (FixedConvert.cpp), no libm and no UB
+		static int	floatToRaw(float num, RoundMode mode = ROUND_NEAREST_AWAY,
+						OverflowMode overflow = OVERFLOW_SATURATE);
+
+		// Integer-only math on raw values (FixedMath.cpp), error bounds there
+		static int	sqrtRaw(int raw);
+		static int	reciprocalRaw(int raw);
+		static int	sinRaw(int raw);
+		static int	cosRaw(int raw);
+		static int	atan2Raw(int y, int x);
+		static int	exp2Raw(int raw);
+		static int	log2Raw(int raw);
+
+		// Exact decimal text I/O on raw values (FixedFormat.cpp), no allocation
+		static const int	formatBufferSize = 20;
+		static size_t		formatRaw(int raw, char* buf);
+		static char const*	parseRaw(char const* begin, char const* end, int& raw);
+		static size_t		formatArray(int const* raw, size_t n, char* buf, char separator);
+		static size_t		parseArray(char const* begin, char const* end, int* raw, size_t n);
+
+		// Batch kernels on raw buffers (FixedBatch.cpp), SSE2/AVX2 when available
+		static void	fromFloatArray(float const* src, int* dst, size_t n);
+		static void	toFloatArray(int const* src, float* dst, size_t n);
+		static void	addArray(int const* a, int const* b, int* dst, size_t n);
+		static void	addSatArray(int const* a, int const* b, int* dst, size_t n);
+		static void	mulArray(int const* a, int const* b, int* dst, size_t n);
+		static int	dot(int const* a, int const* b, size_t n);
+		static void	fir(int const* src, size_t n, int const* taps, size_t nTaps, int* dst);
+
+		// Scalar references, bit-exact with the kernels above
+		static void	fromFloatArrayScalar(float const* src, int* dst, size_t n);
+		static void	toFloatArrayScalar(int const* src, float* dst, size_t n);
+		static void	addArrayScalar(int const* a, int const* b, int* dst, size_t n);
+		static void	addSatArrayScalar(int const* a, int const* b, int* dst, size_t n);
+		static void	mulArrayScalar(int const* a, int const* b, int* dst, size_t n);
+		static int	dotScalar(int const* a, int const* b, size_t n);
+		static void	firScalar(int const* src, size_t n, int const* taps, size_t nTaps, int* dst);
 };
 
 std::ostream& operator<<(std::ostream& os, Fixed const& fixed);
@@ -0,0 +1,344 @@
+#include "Fixed.hpp"
+#include <stdint.h>
+#include <climits>
+
+#if defined(__x86_64__) || defined(__i386__)
+# define FIXED_X86 1
+# include <emmintrin.h>
+# include <immintrin.h>
+#endif
+
+/*
+** Every kernel works on raw Q24.8 values (what getRawBits() returns) so that
+** no Fixed object, and none of its logging, is involved per element.
+**  - fromFloatArray rounds half away from zero, exactly like roundf(), and
+**    saturates like floatToRaw(): out of range clamps to INT_MIN/MAX, NaN is 0.
+**  - addArray and mulArray wrap on overflow, addSatArray clamps to INT_MIN/MAX.
+**  - mulArray, dot and fir use 64-bit products shifted right by 8 (floor).
+**  - fir writes n - nTaps + 1 outputs: dst[j] = sum(taps[k] * src[j + nTaps - 1 - k]).
+*/
+
+// ---------------------------------------------------------------- scalar ----
+
+void	Fixed::fromFloatArrayScalar(float const* src, int* dst, size_t n) {
+	for (size_t i = 0; i < n; i++)
+		dst[i] = floatToRaw(src[i], ROUND_NEAREST_AWAY, OVERFLOW_SATURATE);
+};
+
+void	Fixed::toFloatArrayScalar(int const* src, float* dst, size_t n) {
+	for (size_t i = 0; i < n; i++)
+		dst[i] = src[i] / static_cast<float>(1 << _fractionalBits);
+};
+
+void	Fixed::addArrayScalar(int const* a, int const* b, int* dst, size_t n) {
+	for (size_t i = 0; i < n; i++)
+		dst[i] = static_cast<int>(static_cast<uint32_t>(a[i]) + static_cast<uint32_t>(b[i]));
+};
+
+void	Fixed::addSatArrayScalar(int const* a, int const* b, int* dst, size_t n) {
+	for (size_t i = 0; i < n; i++) {
+		int64_t sum = static_cast<int64_t>(a[i]) + b[i];
+		if (sum > INT_MAX)
+			sum = INT_MAX;
+		else if (sum < INT_MIN)
+			sum = INT_MIN;
+		dst[i] = static_cast<int>(sum);
+	}
+};
+
+void	Fixed::mulArrayScalar(int const* a, int const* b, int* dst, size_t n) {
+	for (size_t i = 0; i < n; i++)
+		dst[i] = static_cast<int>((static_cast<int64_t>(a[i]) * b[i]) >> _fractionalBits);
+};
+
+int	Fixed::dotScalar(int const* a, int const* b, size_t n) {
+	int64_t acc = 0;
+
+	for (size_t i = 0; i < n; i++)
+		acc += static_cast<int64_t>(a[i]) * b[i];
+	return static_cast<int>(acc >> _fractionalBits);
+};
+
+void	Fixed::firScalar(int const* src, size_t n, int const* taps, size_t nTaps, int* dst) {
+	if (nTaps == 0 || n < nTaps)
+		return;
+	for (size_t j = 0; j + nTaps <= n; j++) {
+		int64_t acc = 0;
+		for (size_t k = 0; k < nTaps; k++)
+			acc += static_cast<int64_t>(taps[k]) * src[j + nTaps - 1 - k];
+		dst[j] = static_cast<int>(acc >> _fractionalBits);
+	}
+};
+
+#ifdef FIXED_X86
+
+// ------------------------------------------------------------------ SSE2 ----
+
+/*
+** Out of range (and NaN) cvttps gives 0x80000000, which the rounding step
+** would push to the wrong sign: those lanes are replaced by INT_MAX, INT_MIN
+** or 0 afterwards.
+*/
+static inline __m128i	roundToRawSse2(__m128 x) {
+	__m128i	t = _mm_cvttps_epi32(x);
+	__m128	frac = _mm_sub_ps(x, _mm_cvtepi32_ps(t));
+	__m128	absFrac = _mm_and_ps(frac, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)));
+	__m128i	away = _mm_castps_si128(_mm_cmpge_ps(absFrac, _mm_set1_ps(0.5f)));
+	__m128i	sign = _mm_or_si128(_mm_srai_epi32(_mm_castps_si128(x), 31), _mm_set1_epi32(1));
+	__m128i	rounded = _mm_add_epi32(t, _mm_and_si128(away, sign));
+	__m128i	high = _mm_castps_si128(_mm_cmpge_ps(x, _mm_set1_ps(2147483648.0f)));
+	__m128i	low = _mm_castps_si128(_mm_cmplt_ps(x, _mm_set1_ps(-2147483648.0f)));
+	__m128i	nan = _mm_castps_si128(_mm_cmpunord_ps(x, x));
+	__m128i	clamped = _mm_or_si128(_mm_and_si128(high, _mm_set1_epi32(INT_MAX)),
+		_mm_and_si128(low, _mm_set1_epi32(INT_MIN)));
+
+	rounded = _mm_andnot_si128(_mm_or_si128(_mm_or_si128(high, low), nan), rounded);
+	return _mm_or_si128(rounded, clamped);
+}
+
+static inline __m128i	addSatSse2(__m128i a, __m128i b) {
+	__m128i	sum = _mm_add_epi32(a, b);
+	__m128i	overflow = _mm_srai_epi32(
+		_mm_and_si128(_mm_xor_si128(a, sum), _mm_xor_si128(b, sum)), 31);
+	__m128i	clamp = _mm_xor_si128(_mm_srai_epi32(a, 31), _mm_set1_epi32(0x7fffffff));
+
+	return _mm_or_si128(_mm_and_si128(overflow, clamp), _mm_andnot_si128(overflow, sum));
+}
+
+// ------------------------------------------------------------------ AVX2 ----
+
+# define FIXED_AVX2 __attribute__((target("avx2")))
+
+// Same clamping as roundToRawSse2().
+FIXED_AVX2 static inline __m256i	roundToRawAvx2(__m256 x) {
+	__m256i	t = _mm256_cvttps_epi32(x);
+	__m256	frac = _mm256_sub_ps(x, _mm256_cvtepi32_ps(t));
+	__m256	absFrac = _mm256_and_ps(frac, _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff)));
+	__m256i	away = _mm256_castps_si256(_mm256_cmp_ps(absFrac, _mm256_set1_ps(0.5f), _CMP_GE_OQ));
+	__m256i	sign = _mm256_or_si256(_mm256_srai_epi32(_mm256_castps_si256(x), 31), _mm256_set1_epi32(1));
+	__m256i	rounded = _mm256_add_epi32(t, _mm256_and_si256(away, sign));
+	__m256	high = _mm256_cmp_ps(x, _mm256_set1_ps(2147483648.0f), _CMP_GE_OQ);
+	__m256	low = _mm256_cmp_ps(x, _mm256_set1_ps(-2147483648.0f), _CMP_LT_OQ);
+	__m256	nan = _mm256_cmp_ps(x, x, _CMP_UNORD_Q);
+
+	rounded = _mm256_blendv_epi8(rounded, _mm256_set1_epi32(INT_MAX), _mm256_castps_si256(high));
+	rounded = _mm256_blendv_epi8(rounded, _mm256_set1_epi32(INT_MIN), _mm256_castps_si256(low));
+	return _mm256_andnot_si256(_mm256_castps_si256(nan), rounded);
+}
+
+FIXED_AVX2 static inline __m256i	addSatAvx2(__m256i a, __m256i b) {
+	__m256i	sum = _mm256_add_epi32(a, b);
+	__m256i	overflow = _mm256_srai_epi32(
+		_mm256_and_si256(_mm256_xor_si256(a, sum), _mm256_xor_si256(b, sum)), 31);
+	__m256i	clamp = _mm256_xor_si256(_mm256_srai_epi32(a, 31), _mm256_set1_epi32(0x7fffffff));
+
+	return _mm256_blendv_epi8(sum, clamp, overflow);
+}
+
+// Products of the even and odd lanes as two vectors of four int64.
+FIXED_AVX2 static inline void	mulWideAvx2(__m256i a, __m256i b, __m256i& even, __m256i& odd) {
+	even = _mm256_mul_epi32(a, b);
+	odd = _mm256_mul_epi32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+}
+
+// Low 32 bits of (p >> 8) for each int64: a logical shift gives the same bits.
+FIXED_AVX2 static inline __m256i	packShiftedAvx2(__m256i even, __m256i odd, int shift) {
+	even = _mm256_srl_epi64(even, _mm_cvtsi32_si128(shift));
+	odd = _mm256_sll_epi64(odd, _mm_cvtsi32_si128(32 - shift));
+	return _mm256_blend_epi32(even, odd, 0xAA);
+}
+
+FIXED_AVX2 static int64_t	hsumEpi64Avx2(__m256i v) {
+	__m128i	s = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+	int64_t	lanes[2];
+
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), s);
+	return lanes[0] + lanes[1];
+}
+
+FIXED_AVX2 static size_t	fromFloatAvx2(float const* src, int* dst, size_t n, float scale) {
+	__m256	vscale = _mm256_set1_ps(scale);
+	size_t	i = 0;
+
+	for (; i + 8 <= n; i += 8) {
+		__m256 x = _mm256_mul_ps(_mm256_loadu_ps(src + i), vscale);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), roundToRawAvx2(x));
+	}
+	return i;
+}
+
+FIXED_AVX2 static size_t	toFloatAvx2(int const* src, float* dst, size_t n, float invScale) {
+	__m256	vinv = _mm256_set1_ps(invScale);
+	size_t	i = 0;
+
+	for (; i + 8 <= n; i += 8) {
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i));
+		_mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), vinv));
+	}
+	return i;
+}
+
+FIXED_AVX2 static size_t	addAvx2(int const* a, int const* b, int* dst, size_t n, bool saturate) {
+	size_t	i = 0;
+
+	for (; i + 8 <= n; i += 8) {
+		__m256i va = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i));
+		__m256i vb = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + i));
+		__m256i r = saturate ? addSatAvx2(va, vb) : _mm256_add_epi32(va, vb);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), r);
+	}
+	return i;
+}
+
+FIXED_AVX2 static size_t	mulAvx2(int const* a, int const* b, int* dst, size_t n, int shift) {
+	size_t	i = 0;
+
+	for (; i + 8 <= n; i += 8) {
+		__m256i even, odd;
+		mulWideAvx2(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i)),
+			_mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + i)), even, odd);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), packShiftedAvx2(even, odd, shift));
+	}
+	return i;
+}
+
+FIXED_AVX2 static int64_t	dotAvx2(int const* a, int const* b, size_t n, size_t& done) {
+	__m256i	acc = _mm256_setzero_si256();
+	size_t	i = 0;
+
+	for (; i + 8 <= n; i += 8) {
+		__m256i even, odd;
+		mulWideAvx2(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i)),
+			_mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + i)), even, odd);
+		acc = _mm256_add_epi64(acc, _mm256_add_epi64(even, odd));
+	}
+	done = i;
+	return hsumEpi64Avx2(acc);
+}
+
+// Eight outputs per iteration, one broadcast tap at a time.
+FIXED_AVX2 static size_t	firAvx2(int const* src, size_t outputs, int const* taps,
+	size_t nTaps, int* dst, int shift) {
+	size_t	j = 0;
+
+	for (; j + 8 <= outputs; j += 8) {
+		__m256i accEven = _mm256_setzero_si256();
+		__m256i accOdd = _mm256_setzero_si256();
+		for (size_t k = 0; k < nTaps; k++) {
+			__m256i tap = _mm256_set1_epi32(taps[k]);
+			__m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + j + nTaps - 1 - k));
+			__m256i even, odd;
+			mulWideAvx2(x, tap, even, odd);
+			accEven = _mm256_add_epi64(accEven, even);
+			accOdd = _mm256_add_epi64(accOdd, odd);
+		}
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + j), packShiftedAvx2(accEven, accOdd, shift));
+	}
+	return j;
+}
+
+static bool	hasAvx2(void) {
+	return __builtin_cpu_supports("avx2");
+}
+
+#endif
+
+// ------------------------------------------------------------- dispatch ----
+
+void	Fixed::fromFloatArray(float const* src, int* dst, size_t n) {
+	size_t	i = 0;
+	float	scale = static_cast<float>(1 << _fractionalBits);
+
+#ifdef FIXED_X86
+	if (hasAvx2())
+		i = fromFloatAvx2(src, dst, n, scale);
+	__m128	vscale = _mm_set1_ps(scale);
+	for (; i + 4 <= n; i += 4) {
+		__m128 x = _mm_mul_ps(_mm_loadu_ps(src + i), vscale);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), roundToRawSse2(x));
+	}
+#endif
+	fromFloatArrayScalar(src + i, dst + i, n - i);
+};
+
+void	Fixed::toFloatArray(int const* src, float* dst, size_t n) {
+	size_t	i = 0;
+	float	invScale = 1.0f / (1 << _fractionalBits);
+
+#ifdef FIXED_X86
+	if (hasAvx2())
+		i = toFloatAvx2(src, dst, n, invScale);
+	__m128	vinv = _mm_set1_ps(invScale);
+	for (; i + 4 <= n; i += 4) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+		_mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(v), vinv));
+	}
+#endif
+	toFloatArrayScalar(src + i, dst + i, n - i);
+};
+
+void	Fixed::addArray(int const* a, int const* b, int* dst, size_t n) {
+	size_t	i = 0;
+
+#ifdef FIXED_X86
+	if (hasAvx2())
+		i = addAvx2(a, b, dst, n, false);
+	for (; i + 4 <= n; i += 4) {
+		__m128i va = _mm_loadu_si128(reinterpret_cast<__m128i const*>(a + i));
+		__m128i vb = _mm_loadu_si128(reinterpret_cast<__m128i const*>(b + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_add_epi32(va, vb));
+	}
+#endif
+	addArrayScalar(a + i, b + i, dst + i, n - i);
+};
+
+void	Fixed::addSatArray(int const* a, int const* b, int* dst, size_t n) {
+	size_t	i = 0;
+
+#ifdef FIXED_X86
+	if (hasAvx2())
+		i = addAvx2(a, b, dst, n, true);
+	for (; i + 4 <= n; i += 4) {
+		__m128i va = _mm_loadu_si128(reinterpret_cast<__m128i const*>(a + i));
+		__m128i vb = _mm_loadu_si128(reinterpret_cast<__m128i const*>(b + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), addSatSse2(va, vb));
+	}
+#endif
+	addSatArrayScalar(a + i, b + i, dst + i, n - i);
+};
+
+// SSE2 has no signed 32x32->64 multiply, so only AVX2 is vectorized here.
+void	Fixed::mulArray(int const* a, int const* b, int* dst, size_t n) {
+	size_t	i = 0;
+
+#ifdef FIXED_X86
+	if (hasAvx2())
+		i = mulAvx2(a, b, dst, n, _fractionalBits);
+#endif
+	mulArrayScalar(a + i, b + i, dst + i, n - i);
+};
+
+int	Fixed::dot(int const* a, int const* b, size_t n) {
+	size_t	i = 0;
+	int64_t	acc = 0;
+
+#ifdef FIXED_X86
+	if (hasAvx2())
+		acc = dotAvx2(a, b, n, i);
+#endif
+	for (; i < n; i++)
+		acc += static_cast<int64_t>(a[i]) * b[i];
+	return static_cast<int>(acc >> _fractionalBits);
+};
+
+void	Fixed::fir(int const* src, size_t n, int const* taps, size_t nTaps, int* dst) {
+	size_t	j = 0;
+
+	if (nTaps == 0 || n < nTaps)
+		return;
+#ifdef FIXED_X86
+	if (hasAvx2())
+		j = firAvx2(src, n - nTaps + 1, taps, nTaps, dst, _fractionalBits);
+#endif
+	firScalar(src + j, n - j, taps, nTaps, dst + j);
+};
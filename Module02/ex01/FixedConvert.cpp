@@ -0,0 +1,60 @@
+#include "Fixed.hpp"
+#include <stdint.h>
+#include <climits>
+#include <cstring>
+
+/*
+** float -> raw Q24.8 straight from the IEEE-754 fields:
+**   value * 2^8 = mantissa * 2^(exponent - 127 - 23 + 8)
+** The mantissa is shifted into a 64-bit magnitude, the bits shifted out decide
+** the rounding, then the sign is applied and the result is clamped or wrapped.
+** NaN gives 0, infinities saturate (or wrap to 0, as any multiple of 2^32).
+**
+** No branches, the modes included: both shift directions, every rounding
+** increment and both overflow results are computed, then picked with masks
+** (min(a, b) = b ^ ((a ^ b) & -(a < b)), negation = (q ^ neg) - neg).
+*/
+
+static inline int64_t	minMask(int64_t a, int64_t b) {
+	return b ^ ((a ^ b) & -static_cast<int64_t>(a < b));
+}
+
+// All ones when condition holds, else zero.
+static inline uint64_t	mask(bool condition) {
+	return -static_cast<uint64_t>(condition);
+}
+
+int	Fixed::floatToRaw(float num, RoundMode mode, OverflowMode overflow) {
+	uint32_t	bits;
+
+	std::memcpy(&bits, &num, sizeof(bits));
+
+	uint32_t	exponent = (bits >> 23) & 0xff;
+	uint64_t	mantissa = (bits & 0x7fffff) | (static_cast<uint64_t>(exponent != 0) << 23);
+	uint64_t	negative = mask(bits >> 31);
+	uint64_t	isNan = mask((exponent == 0xff) & ((bits & 0x7fffff) != 0));
+	// Subnormals share the exponent of the smallest normal.
+	int64_t		shift = static_cast<int64_t>(exponent + (exponent == 0)) - 127 - 23 + _fractionalBits;
+
+	int64_t		left = minMask(shift & ~(shift >> 63), 39);
+	int64_t		right = minMask(-shift & (shift >> 63), 40);
+	uint64_t	magnitude = mantissa << left;
+	uint64_t	unit = static_cast<uint64_t>(1) << right;
+	uint64_t	quotient = magnitude >> right;
+	uint64_t	rest = magnitude & (unit - 1);
+	uint64_t	twice = rest << 1;
+
+	uint64_t	up = (mask(mode == ROUND_NEAREST_EVEN) & ((twice > unit) | ((twice == unit) & quotient)))
+		| (mask(mode == ROUND_NEAREST_AWAY) & (twice >= unit))
+		| (mask(mode == ROUND_FLOOR) & negative & (rest != 0));
+	quotient += up & 1;
+
+	int64_t	value = static_cast<int64_t>(((quotient ^ negative) - negative) & ~isNan);
+	int64_t	saturated = minMask(value, INT_MAX);
+
+	saturated = -minMask(-saturated, -static_cast<int64_t>(INT_MIN));
+
+	uint64_t wrap = mask(overflow == OVERFLOW_WRAP);
+	return static_cast<int>(static_cast<uint32_t>((static_cast<uint64_t>(value) & wrap)
+		| (static_cast<uint64_t>(saturated) & ~wrap)));
+};
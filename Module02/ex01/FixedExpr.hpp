@@ -0,0 +1,152 @@
+#ifndef FIXEDEXPR_HPP
+# define FIXEDEXPR_HPP
+# include <cstddef>
+# include <iostream>
+# include <stdint.h>
+# include "Fixed.hpp"
+
+/*
+** Expression templates over raw Q24.8 values. `a * b + c` builds a small tree
+** of nodes; nothing is computed until it is assigned to a FixedVector or a
+** FixedMatrix, which then runs one loop calling node[i] (all inline).
+** Containers enter the tree as FixedLeaf (pointer + size), nodes are held by
+** value, so an expression never copies element data.
+**
+** Operands of a binary node must have the same size. When they do not, the
+** node's size() is FIXED_SIZE_MISMATCH, which propagates up the tree and is
+** rejected wherever an expression is evaluated.
+*/
+
+static const size_t	FIXED_SIZE_MISMATCH = static_cast<size_t>(-1);
+
+template <class E>
+class FixedExpr {
+	public:
+		E const&	self(void) const { return static_cast<E const&>(*this); }
+};
+
+template <class C>
+class FixedLeaf : public FixedExpr< FixedLeaf<C> > {
+	private:
+		int const*	_data;
+		size_t		_size;
+
+	public:
+		FixedLeaf(C const& container) : _data(container.data()), _size(container.size()) {}
+
+		int		operator[](size_t i) const { return _data[i]; }
+		size_t	size(void) const { return _size; }
+};
+
+// How an operand is stored inside a node: by value, containers as leaves.
+template <class E>
+struct FixedOperand {
+	typedef E	type;
+};
+
+template <class L, class R>
+class FixedAddExpr : public FixedExpr< FixedAddExpr<L, R> > {
+	private:
+		typename FixedOperand<L>::type	_lhs;
+		typename FixedOperand<R>::type	_rhs;
+
+	public:
+		FixedAddExpr(L const& lhs, R const& rhs) : _lhs(lhs), _rhs(rhs) {}
+
+		int		operator[](size_t i) const {
+			return static_cast<int>(static_cast<uint32_t>(_lhs[i]) + static_cast<uint32_t>(_rhs[i]));
+		}
+		size_t	size(void) const {
+			return _lhs.size() == _rhs.size() ? _lhs.size() : FIXED_SIZE_MISMATCH;
+		}
+};
+
+template <class L, class R>
+class FixedSubExpr : public FixedExpr< FixedSubExpr<L, R> > {
+	private:
+		typename FixedOperand<L>::type	_lhs;
+		typename FixedOperand<R>::type	_rhs;
+
+	public:
+		FixedSubExpr(L const& lhs, R const& rhs) : _lhs(lhs), _rhs(rhs) {}
+
+		int		operator[](size_t i) const {
+			return static_cast<int>(static_cast<uint32_t>(_lhs[i]) - static_cast<uint32_t>(_rhs[i]));
+		}
+		size_t	size(void) const {
+			return _lhs.size() == _rhs.size() ? _lhs.size() : FIXED_SIZE_MISMATCH;
+		}
+};
+
+// Element-wise product, same rounding as Fixed::mulArray.
+template <class L, class R>
+class FixedMulExpr : public FixedExpr< FixedMulExpr<L, R> > {
+	private:
+		typename FixedOperand<L>::type	_lhs;
+		typename FixedOperand<R>::type	_rhs;
+
+	public:
+		FixedMulExpr(L const& lhs, R const& rhs) : _lhs(lhs), _rhs(rhs) {}
+
+		int		operator[](size_t i) const {
+			return static_cast<int>((static_cast<int64_t>(_lhs[i]) * _rhs[i]) >> Fixed::rawFractionalBits);
+		}
+		size_t	size(void) const {
+			return _lhs.size() == _rhs.size() ? _lhs.size() : FIXED_SIZE_MISMATCH;
+		}
+};
+
+template <class E>
+class FixedScaleExpr : public FixedExpr< FixedScaleExpr<E> > {
+	private:
+		typename FixedOperand<E>::type	_expr;
+		int								_factor;
+
+	public:
+		FixedScaleExpr(E const& expr, int factor) : _expr(expr), _factor(factor) {}
+
+		int		operator[](size_t i) const {
+			return static_cast<int>((static_cast<int64_t>(_expr[i]) * _factor) >> Fixed::rawFractionalBits);
+		}
+		size_t	size(void) const { return _expr.size(); }
+};
+
+template <class L, class R>
+FixedAddExpr<L, R>	operator+(FixedExpr<L> const& lhs, FixedExpr<R> const& rhs) {
+	return FixedAddExpr<L, R>(lhs.self(), rhs.self());
+}
+
+template <class L, class R>
+FixedSubExpr<L, R>	operator-(FixedExpr<L> const& lhs, FixedExpr<R> const& rhs) {
+	return FixedSubExpr<L, R>(lhs.self(), rhs.self());
+}
+
+template <class L, class R>
+FixedMulExpr<L, R>	operator*(FixedExpr<L> const& lhs, FixedExpr<R> const& rhs) {
+	return FixedMulExpr<L, R>(lhs.self(), rhs.self());
+}
+
+// Scale by a raw factor (Fixed(x).getRawBits()), without a Fixed per element.
+template <class E>
+FixedScaleExpr<E>	fixedScale(FixedExpr<E> const& expr, int rawFactor) {
+	return FixedScaleExpr<E>(expr.self(), rawFactor);
+}
+
+// Sum of products in 64 bits, shifted once: the raw value of the dot product
+// (0 when the sizes differ).
+template <class L, class R>
+int	fixedDot(FixedExpr<L> const& lhs, FixedExpr<R> const& rhs) {
+	typename FixedOperand<L>::type	a(lhs.self());
+	typename FixedOperand<R>::type	b(rhs.self());
+	int64_t							acc = 0;
+
+	if (a.size() != b.size() || a.size() == FIXED_SIZE_MISMATCH) {
+		std::cerr << "Error: fixedDot size mismatch\n";
+		return 0;
+	}
+	for (size_t i = 0; i < a.size(); i++)
+		acc += static_cast<int64_t>(a[i]) * b[i];
+	return static_cast<int>(acc >> Fixed::rawFractionalBits);
+}
+
+#endif
@@ -0,0 +1,127 @@
+#include "Fixed.hpp"
+#include <stdint.h>
+
+/*
+** Exact decimal text for raw Q24.8 values, integer math only.
+** Every raw value has a finite decimal form: frac / 256 = frac * 390625 / 10^8,
+** so at most 8 fractional digits are printed (trailing zeros dropped, no '.'
+** for whole numbers): 10860 -> "42.421875", -128 -> "-0.5", 2560 -> "10".
+** Parsing rounds to the nearest raw value, halves away from zero like roundf().
+*/
+
+static char*	writeRaw(int raw, char* out) {
+	uint32_t	magnitude = raw < 0 ? 0u - static_cast<uint32_t>(raw) : static_cast<uint32_t>(raw);
+	uint32_t	whole = magnitude >> 8;
+	uint32_t	frac = (magnitude & 0xff) * 390625u;
+	char		digits[10];
+	int			count = 0;
+
+	if (raw < 0)
+		*out++ = '-';
+	do {
+		digits[count++] = static_cast<char>('0' + whole % 10);
+		whole /= 10;
+	} while (whole);
+	while (count)
+		*out++ = digits[--count];
+	if (frac) {
+		int width = 8;
+		while (frac % 10 == 0) {
+			frac /= 10;
+			width--;
+		}
+		*out++ = '.';
+		for (int i = width - 1; i >= 0; i--) {
+			out[i] = static_cast<char>('0' + frac % 10);
+			frac /= 10;
+		}
+		out += width;
+	}
+	return out;
+}
+
+size_t	Fixed::formatRaw(int raw, char* buf) {
+	char* end = writeRaw(raw, buf);
+
+	*end = '\0';
+	return end - buf;
+};
+
+/*
+** Only the first 9 fractional digits matter: every multiple of 1/512 (the
+** points where rounding to 1/256 can change) is exact in 9 digits, so the
+** truncated value lands on the same side of each of them.
+*/
+char const*	Fixed::parseRaw(char const* begin, char const* end, int& raw) {
+	char const*	p = begin;
+	bool		negative = false;
+	uint64_t	whole = 0;
+	uint64_t	frac = 0;
+	int			fracDigits = 0;
+	bool		anyDigit = false;
+
+	if (p < end && (*p == '-' || *p == '+'))
+		negative = *p++ == '-';
+	for (; p < end && *p >= '0' && *p <= '9'; p++) {
+		whole = whole * 10 + (*p - '0');
+		if (whole > (static_cast<uint64_t>(1) << (31 - _fractionalBits)))
+			return NULL;
+		anyDigit = true;
+	}
+	if (p < end && *p == '.') {
+		for (p++; p < end && *p >= '0' && *p <= '9'; p++) {
+			if (fracDigits < 9) {
+				frac = frac * 10 + (*p - '0');
+				fracDigits++;
+			}
+			anyDigit = true;
+		}
+	}
+	if (!anyDigit)
+		return NULL;
+	for (; fracDigits < 9; fracDigits++)
+		frac *= 10;
+
+	uint64_t	halfSteps = (frac << (_fractionalBits + 1)) / 1000000000u;
+	uint64_t	magnitude = (whole << _fractionalBits) + ((halfSteps + 1) >> 1);
+	uint64_t	limit = negative ? static_cast<uint64_t>(1) << 31 : (static_cast<uint64_t>(1) << 31) - 1;
+
+	if (magnitude > limit)
+		return NULL;
+	raw = negative ? static_cast<int>(0u - static_cast<uint32_t>(magnitude)) : static_cast<int>(magnitude);
+	return p;
+};
+
+// Buffer must hold n * formatBufferSize bytes; nothing is NUL-terminated.
+size_t	Fixed::formatArray(int const* raw, size_t n, char* buf, char separator) {
+	char*	out = buf;
+
+	for (size_t i = 0; i < n; i++) {
+		out = writeRaw(raw[i], out);
+		*out++ = separator;
+	}
+	return out - buf;
+};
+
+static bool	isSeparator(char c) {
+	return c == ',' || c == ';' || c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// Fields are separated by any run of ',', ';', blanks or line breaks. Stops
+// at the first malformed field or after n values; returns the count parsed.
+size_t	Fixed::parseArray(char const* begin, char const* end, int* raw, size_t n) {
+	char const*	p = begin;
+	size_t		count = 0;
+
+	while (count < n) {
+		while (p < end && isSeparator(*p))
+			p++;
+		if (p == end)
+			break;
+		p = parseRaw(p, end, raw[count]);
+		if (!p || (p < end && !isSeparator(*p)))
+			break;
+		count++;
+	}
+	return count;
+};
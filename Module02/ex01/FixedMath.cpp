@@ -0,0 +1,275 @@
+#include "Fixed.hpp"
+#include <stdint.h>
+#include <climits>
+
+/*
+** Float-free math on raw Q24.8 values. Intermediate results are kept in Q.30
+** (or wider) and rounded once to Q24.8, so the bounds below are in LSB of the
+** result (1 LSB = 1/256). check.cpp (`make check`) holds every function to
+** its bound against libm over the ranges mentioned.
+*/
+
+static const int64_t	HALF_PI_Q30 = 1686629713LL;
+static const int		CORDIC_STEPS = 16;
+
+// atan(2^-i) in Q.30; 16 steps leave ~2^-16 rad, well under the 2^-8 output step
+static const int64_t	ATAN_Q30[CORDIC_STEPS] = {
+	843314857, 497837829, 263043837, 133525159, 67021687, 33543516, 16775851,
+	8388437, 4194283, 2097149, 1048576, 524288, 262144, 131072, 65536, 32768
+};
+
+// sqrt(i + 0.5) * 2^11 for i in [256, 1024): the seed from the top 10 bits
+static const uint16_t	SQRT_SEED[768] = {
+	32800, 32864, 32928, 32991, 33055, 33118, 33181, 33245, 33308, 33370, 33433, 33496, 33558, 33621, 33683, 33745,
+	33808, 33869, 33931, 33993, 34055, 34116, 34178, 34239, 34300, 34361, 34422, 34483, 34544, 34605, 34665, 34726,
+	34786, 34846, 34906, 34966, 35026, 35086, 35146, 35205, 35265, 35324, 35384, 35443, 35502, 35561, 35620, 35679,
+	35737, 35796, 35855, 35913, 35971, 36030, 36088, 36146, 36204, 36262, 36320, 36377, 36435, 36492, 36550, 36607,
+	36664, 36722, 36779, 36836, 36892, 36949, 37006, 37063, 37119, 37176, 37232, 37288, 37344, 37401, 37457, 37513,
+	37568, 37624, 37680, 37735, 37791, 37846, 37902, 37957, 38012, 38067, 38123, 38177, 38232, 38287, 38342, 38397,
+	38451, 38506, 38560, 38614, 38669, 38723, 38777, 38831, 38885, 38939, 38993, 39047, 39100, 39154, 39207, 39261,
+	39314, 39367, 39421, 39474, 39527, 39580, 39633, 39686, 39739, 39791, 39844, 39897, 39949, 40002, 40054, 40106,
+	40159, 40211, 40263, 40315, 40367, 40419, 40471, 40522, 40574, 40626, 40677, 40729, 40780, 40832, 40883, 40934,
+	40986, 41037, 41088, 41139, 41190, 41241, 41291, 41342, 41393, 41444, 41494, 41545, 41595, 41645, 41696, 41746,
+	41796, 41846, 41896, 41947, 41996, 42046, 42096, 42146, 42196, 42245, 42295, 42345, 42394, 42444, 42493, 42542,
+	42592, 42641, 42690, 42739, 42788, 42837, 42886, 42935, 42984, 43032, 43081, 43130, 43178, 43227, 43275, 43324,
+	43372, 43420, 43469, 43517, 43565, 43613, 43661, 43709, 43757, 43805, 43853, 43901, 43949, 43996, 44044, 44091,
+	44139, 44187, 44234, 44281, 44329, 44376, 44423, 44470, 44518, 44565, 44612, 44659, 44706, 44752, 44799, 44846,
+	44893, 44939, 44986, 45033, 45079, 45126, 45172, 45219, 45265, 45311, 45358, 45404, 45450, 45496, 45542, 45588,
+	45634, 45680, 45726, 45772, 45818, 45863, 45909, 45955, 46000, 46046, 46091, 46137, 46182, 46228, 46273, 46318,
+	46364, 46409, 46454, 46499, 46544, 46589, 46634, 46679, 46724, 46769, 46814, 46858, 46903, 46948, 46993, 47037,
+	47082, 47126, 47171, 47215, 47260, 47304, 47348, 47393, 47437, 47481, 47525, 47569, 47613, 47657, 47701, 47745,
+	47789, 47833, 47877, 47921, 47964, 48008, 48052, 48095, 48139, 48182, 48226, 48269, 48313, 48356, 48400, 48443,
+	48486, 48529, 48573, 48616, 48659, 48702, 48745, 48788, 48831, 48874, 48917, 48960, 49002, 49045, 49088, 49131,
+	49173, 49216, 49259, 49301, 49344, 49386, 49429, 49471, 49513, 49556, 49598, 49640, 49682, 49725, 49767, 49809,
+	49851, 49893, 49935, 49977, 50019, 50061, 50103, 50145, 50186, 50228, 50270, 50312, 50353, 50395, 50437, 50478,
+	50520, 50561, 50603, 50644, 50685, 50727, 50768, 50809, 50851, 50892, 50933, 50974, 51015, 51056, 51097, 51139,
+	51180, 51220, 51261, 51302, 51343, 51384, 51425, 51466, 51506, 51547, 51588, 51628, 51669, 51709, 51750, 51791,
+	51831, 51871, 51912, 51952, 51993, 52033, 52073, 52113, 52154, 52194, 52234, 52274, 52314, 52354, 52394, 52434,
+	52474, 52514, 52554, 52594, 52634, 52674, 52714, 52753, 52793, 52833, 52873, 52912, 52952, 52991, 53031, 53070,
+	53110, 53149, 53189, 53228, 53268, 53307, 53346, 53386, 53425, 53464, 53503, 53543, 53582, 53621, 53660, 53699,
+	53738, 53777, 53816, 53855, 53894, 53933, 53972, 54011, 54049, 54088, 54127, 54166, 54204, 54243, 54282, 54320,
+	54359, 54397, 54436, 54474, 54513, 54551, 54590, 54628, 54667, 54705, 54743, 54782, 54820, 54858, 54896, 54935,
+	54973, 55011, 55049, 55087, 55125, 55163, 55201, 55239, 55277, 55315, 55353, 55391, 55429, 55466, 55504, 55542,
+	55580, 55617, 55655, 55693, 55730, 55768, 55806, 55843, 55881, 55918, 55956, 55993, 56031, 56068, 56105, 56143,
+	56180, 56218, 56255, 56292, 56329, 56367, 56404, 56441, 56478, 56515, 56552, 56589, 56626, 56663, 56700, 56737,
+	56774, 56811, 56848, 56885, 56922, 56959, 56996, 57032, 57069, 57106, 57143, 57179, 57216, 57252, 57289, 57326,
+	57362, 57399, 57435, 57472, 57508, 57545, 57581, 57618, 57654, 57690, 57727, 57763, 57799, 57836, 57872, 57908,
+	57944, 57980, 58017, 58053, 58089, 58125, 58161, 58197, 58233, 58269, 58305, 58341, 58377, 58413, 58449, 58485,
+	58521, 58556, 58592, 58628, 58664, 58699, 58735, 58771, 58806, 58842, 58878, 58913, 58949, 58985, 59020, 59056,
+	59091, 59127, 59162, 59197, 59233, 59268, 59304, 59339, 59374, 59410, 59445, 59480, 59515, 59551, 59586, 59621,
+	59656, 59691, 59727, 59762, 59797, 59832, 59867, 59902, 59937, 59972, 60007, 60042, 60077, 60112, 60146, 60181,
+	60216, 60251, 60286, 60320, 60355, 60390, 60425, 60459, 60494, 60529, 60563, 60598, 60633, 60667, 60702, 60736,
+	60771, 60805, 60840, 60874, 60909, 60943, 60977, 61012, 61046, 61081, 61115, 61149, 61183, 61218, 61252, 61286,
+	61320, 61355, 61389, 61423, 61457, 61491, 61525, 61559, 61593, 61627, 61661, 61695, 61729, 61763, 61797, 61831,
+	61865, 61899, 61933, 61967, 62001, 62034, 62068, 62102, 62136, 62170, 62203, 62237, 62271, 62304, 62338, 62372,
+	62405, 62439, 62472, 62506, 62539, 62573, 62607, 62640, 62673, 62707, 62740, 62774, 62807, 62841, 62874, 62907,
+	62941, 62974, 63007, 63040, 63074, 63107, 63140, 63173, 63207, 63240, 63273, 63306, 63339, 63372, 63405, 63438,
+	63471, 63505, 63538, 63571, 63604, 63636, 63669, 63702, 63735, 63768, 63801, 63834, 63867, 63900, 63932, 63965,
+	63998, 64031, 64063, 64096, 64129, 64162, 64194, 64227, 64260, 64292, 64325, 64357, 64390, 64423, 64455, 64488,
+	64520, 64553, 64585, 64618, 64650, 64682, 64715, 64747, 64780, 64812, 64844, 64877, 64909, 64941, 64974, 65006,
+	65038, 65070, 65103, 65135, 65167, 65199, 65231, 65263, 65296, 65328, 65360, 65392, 65424, 65456, 65488, 65520
+};
+
+// sin(i * pi / 256) in Q.30, i in [0, 128]: a quarter wave, linearly interpolated
+static const int32_t	SIN_Q30[129] = {
+	0, 13176464, 26350943, 39521455, 52686014, 65842639, 78989349,
+	92124163, 105245103, 118350194, 131437462, 144504935, 157550647, 170572633,
+	183568930, 196537583, 209476638, 222384147, 235258165, 248096755, 260897982,
+	273659918, 286380643, 299058239, 311690799, 324276419, 336813204, 349299266,
+	361732726, 374111709, 386434353, 398698801, 410903207, 423045732, 435124548,
+	447137835, 459083786, 470960600, 482766489, 494499676, 506158392, 517740883,
+	529245404, 540670223, 552013618, 563273883, 574449320, 585538248, 596538995,
+	607449906, 618269338, 628995660, 639627258, 650162530, 660599890, 670937767,
+	681174602, 691308855, 701339000, 711263525, 721080937, 730789757, 740388522,
+	749875788, 759250125, 768510122, 777654384, 786681534, 795590213, 804379079,
+	813046808, 821592095, 830013654, 838310216, 846480531, 854523370, 862437520,
+	870221790, 877875009, 885396022, 892783698, 900036924, 907154608, 914135678,
+	920979082, 927683790, 934248793, 940673101, 946955747, 953095785, 959092290,
+	964944360, 970651112, 976211688, 981625251, 986890984, 992008094, 996975812,
+	1001793390, 1006460100, 1010975242, 1015338134, 1019548121, 1023604567, 1027506862,
+	1031254418, 1034846671, 1038283080, 1041563127, 1044686319, 1047652185, 1050460278,
+	1053110176, 1055601479, 1057933813, 1060106826, 1062120190, 1063973603, 1065666786,
+	1067199483, 1068571464, 1069782521, 1070832474, 1071721163, 1072448455, 1073014240,
+	1073418433, 1073660973, 1073741824
+};
+
+// 2^64 / (2 * pi * 256): a raw angle times this is the angle in 2^-64 turns
+static const uint64_t	TURNS_PER_RAW_Q64 = 11468322278445318ULL;
+
+// 2^(a/16) and 2^(b/256) in Q.30: 2^(f/256) = EXP2_HI[f >> 4] * EXP2_LO[f & 15]
+static const uint64_t	EXP2_HI[16] = {
+	1073741824, 1121280436, 1170923762, 1222764986, 1276901417, 1333434672,
+	1392470869, 1454120821, 1518500250, 1585730000, 1655936265, 1729250827,
+	1805811301, 1885761398, 1969251188, 2056437387
+};
+static const uint64_t	EXP2_LO[16] = {
+	1073741824, 1076653033, 1079572136, 1082499153, 1085434106, 1088377016,
+	1091327906, 1094286796, 1097253708, 1100228665, 1103211687, 1106202798,
+	1109202018, 1112209370, 1115224875, 1118248556
+};
+
+static int	roundQ30ToRaw(int64_t v) {
+	return static_cast<int>((v + (1 << 21)) >> 22);
+}
+
+/*
+** Sine of a phase in 2^-32 turns, in Q.30. The top two bits are the quadrant;
+** odd quadrants read the quarter wave backwards (one 2^-32 turn off, far below
+** the output step). 128 intervals leave 0.005 LSB of interpolation error.
+*/
+static int64_t	sinPhase(uint32_t phase) {
+	uint32_t	pos = phase & 0x3fffffff;
+
+	if (phase & 0x40000000)
+		pos = 0x3fffffff - pos;
+
+	uint32_t	index = pos >> 23;
+	int64_t		frac = pos & 0x7fffff;
+	int64_t		value = SIN_Q30[index] + (((SIN_Q30[index + 1] - SIN_Q30[index]) * frac) >> 23);
+
+	return phase & 0x80000000 ? -value : value;
+}
+
+// Angle to turns by one wrapping multiply: no division, exact range reduction.
+static uint32_t	rawToPhase(int raw) {
+	uint64_t turns = static_cast<uint64_t>(static_cast<int64_t>(raw)) * TURNS_PER_RAW_Q64;
+
+	return static_cast<uint32_t>(turns >> 32);
+}
+
+/*
+** Round to nearest, exact on [0, INT_MAX]; negative input gives 0. The root
+** of raw << 8 is seeded from a table on its top 10 bits (2^-9 relative),
+** refined by one Newton step (2^-19, at most 2 too high), then corrected to
+** the exact floor and rounded. Values under 2^32 use a 32-bit division.
+*/
+int	Fixed::sqrtRaw(int raw) {
+	if (raw <= 0)
+		return 0;
+
+	uint64_t	value = static_cast<uint64_t>(raw) << _fractionalBits;
+	int			top = (63 - __builtin_clzll(value)) & ~1;
+	uint64_t	root = (static_cast<uint64_t>(SQRT_SEED[(value >> (top - 8)) - 256]) << (top >> 1)) >> 15;
+
+	if (value >> 32)
+		root = (root + value / root) >> 1;
+	else
+		root = (root + static_cast<uint32_t>(value) / static_cast<uint32_t>(root)) >> 1;
+	while (root * root > value)
+		root--;
+	return static_cast<int>(value - root * root > root ? root + 1 : root);
+};
+
+// Newton-Raphson on the mantissa normalized to [0.5, 1), 3 steps from the
+// 48/17 - 32/17 d estimate. <= 0.5 LSB on the whole range; 0 gives INT_MAX.
+int	Fixed::reciprocalRaw(int raw) {
+	if (raw == 0)
+		return INT_MAX;
+
+	bool		negative = raw < 0;
+	uint32_t	divisor = negative ? 0u - static_cast<uint32_t>(raw) : static_cast<uint32_t>(raw);
+	int			shift = __builtin_clz(divisor);
+	int64_t		d = static_cast<int64_t>(static_cast<uint64_t>(divisor) << shift);
+	int64_t		r = 3031741621LL - static_cast<int64_t>((2021161081ULL * static_cast<uint64_t>(d)) >> 32);
+
+	for (int i = 0; i < 3; i++) {
+		int64_t e = static_cast<int64_t>((static_cast<uint64_t>(d) * static_cast<uint64_t>(r)) >> 32);
+		r = (r * ((static_cast<int64_t>(1) << 31) - e)) >> 30;
+	}
+
+	int		down = 46 - shift;
+	int64_t	result = (r + (static_cast<int64_t>(1) << (down - 1))) >> down;
+
+	return static_cast<int>(negative ? -result : result);
+};
+
+// Quarter-wave table: <= 0.505 LSB for every raw value.
+int	Fixed::sinRaw(int raw) {
+	return roundQ30ToRaw(sinPhase(rawToPhase(raw)));
+};
+
+int	Fixed::cosRaw(int raw) {
+	return roundQ30ToRaw(sinPhase(rawToPhase(raw) + 0x40000000u));
+};
+
+// CORDIC vectoring after a quarter-turn pre-rotation for x < 0. Result in
+// [-pi, pi], <= 0.51 LSB for any input; atan2(0, 0) is 0.
+int	Fixed::atan2Raw(int y, int x) {
+	if (x == 0 && y == 0)
+		return 0;
+
+	int64_t	vx = x;
+	int64_t	vy = y;
+	int64_t	angle = 0;
+	int64_t	larger = (vx < 0 ? -vx : vx) > (vy < 0 ? -vy : vy) ? (vx < 0 ? -vx : vx) : (vy < 0 ? -vy : vy);
+
+	while (larger < (static_cast<int64_t>(1) << 29)) {
+		vx <<= 1;
+		vy <<= 1;
+		larger <<= 1;
+	}
+	if (vx < 0) {
+		int64_t tmp = vx;
+		if (vy >= 0) {
+			vx = vy;
+			vy = -tmp;
+			angle = HALF_PI_Q30;
+		} else {
+			vx = -vy;
+			vy = tmp;
+			angle = -HALF_PI_Q30;
+		}
+	}
+	for (int i = 0; i < CORDIC_STEPS; i++) {
+		int64_t s = -static_cast<int64_t>(vy <= 0);
+		int64_t dx = vy >> i;
+		int64_t dy = vx >> i;
+		vx += (dx ^ s) - s;
+		vy -= (dy ^ s) - s;
+		angle += (ATAN_Q30[i] ^ s) - s;
+	}
+	return roundQ30ToRaw(angle);
+};
+
+// Two 16-entry tables cover the 256 fractional steps; their Q.60 product is
+// rounded once. <= 0.5 LSB + 2^-30 relative (under 2 LSB near INT_MAX);
+// saturates at INT_MAX and underflows to 0.
+int	Fixed::exp2Raw(int raw) {
+	int			whole = raw >> _fractionalBits;
+	int			frac = raw & ((1 << _fractionalBits) - 1);
+	uint64_t	product = EXP2_HI[frac >> 4] * EXP2_LO[frac & 15];
+	int			down = 60 - _fractionalBits - whole;
+
+	if (down < 30)
+		return INT_MAX;
+	if (down > 63)
+		return 0;
+
+	uint64_t	result = (product + (static_cast<uint64_t>(1) << (down - 1))) >> down;
+
+	return result > static_cast<uint64_t>(INT_MAX) ? INT_MAX : static_cast<int>(result);
+};
+
+// Exponent from the leading bit, fraction by repeated squaring (20 bits), then
+// rounded: <= 0.5 LSB plus 2^-12 LSB. Non-positive input gives INT_MIN.
+int	Fixed::log2Raw(int raw) {
+	if (raw <= 0)
+		return INT_MIN;
+
+	int			exponent = 31 - __builtin_clz(static_cast<uint32_t>(raw));
+	uint64_t	mantissa = static_cast<uint64_t>(raw) << (30 - exponent);
+	int64_t		frac = 0;
+
+	for (int i = 0; i < 20; i++) {
+		mantissa = (mantissa * mantissa) >> 30;
+		frac <<= 1;
+		if (mantissa >= (static_cast<uint64_t>(1) << 31)) {
+			mantissa >>= 1;
+			frac |= 1;
+		}
+	}
+
+	int64_t	result = (static_cast<int64_t>(exponent - _fractionalBits) << 20) + frac;
+
+	return static_cast<int>((result + (1 << 11)) >> 12);
+};
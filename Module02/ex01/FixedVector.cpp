@@ -0,0 +1,73 @@
+#include "FixedVector.hpp"
+#include <stdint.h>
+
+FixedVector::FixedVector() : _storage(NULL), _data(NULL), _size(0) {};
+
+FixedVector::FixedVector(size_t size) : _storage(NULL), _data(NULL), _size(0) {
+	allocate(size);
+	fill(0);
+};
+
+FixedVector::FixedVector(FixedVector const& src) : FixedExpr<FixedVector>(), _storage(NULL), _data(NULL), _size(0) {
+	allocate(src._size);
+	for (size_t i = 0; i < _size; i++)
+		_data[i] = src._data[i];
+};
+
+FixedVector& FixedVector::operator=(FixedVector const& rhs) {
+	if (this != &rhs) {
+		if (_size != rhs._size) {
+			delete[] _storage;
+			_storage = NULL;
+			allocate(rhs._size);
+		}
+		for (size_t i = 0; i < _size; i++)
+			_data[i] = rhs._data[i];
+	}
+	return *this;
+};
+
+FixedVector::~FixedVector() {
+	delete[] _storage;
+};
+
+// Over-allocate by the alignment and round the data pointer up.
+void	FixedVector::allocate(size_t size) {
+	_size = size;
+	_storage = new char[size * sizeof(int) + _alignment];
+	uintptr_t address = reinterpret_cast<uintptr_t>(_storage);
+	_data = reinterpret_cast<int*>((address + _alignment - 1) & ~static_cast<uintptr_t>(_alignment - 1));
+};
+
+size_t	FixedVector::size(void) const {
+	return _size;
+};
+
+int*	FixedVector::data(void) {
+	return _data;
+};
+
+int const*	FixedVector::data(void) const {
+	return _data;
+};
+
+int	FixedVector::getRaw(size_t i) const {
+	return _data[i];
+};
+
+void	FixedVector::setRaw(size_t i, int raw) {
+	_data[i] = raw;
+};
+
+float	FixedVector::toFloat(size_t i) const {
+	return _data[i] / static_cast<float>(1 << Fixed::rawFractionalBits);
+};
+
+void	FixedVector::setFloat(size_t i, float value) {
+	_data[i] = Fixed::floatToRaw(value);
+};
+
+void	FixedVector::fill(int raw) {
+	for (size_t i = 0; i < _size; i++)
+		_data[i] = raw;
+};
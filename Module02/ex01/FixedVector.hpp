@@ -0,0 +1,77 @@
+#ifndef FIXEDVECTOR_HPP
+# define FIXEDVECTOR_HPP
+# include <iostream>
+# include "FixedExpr.hpp"
+
+/*
+** Contiguous raw Q24.8 values, 32-byte aligned for the SIMD kernels.
+** Elements are plain ints: copying or assigning never goes through Fixed.
+*/
+class FixedVector : public FixedExpr<FixedVector> {
+	private:
+		static const size_t	_alignment = 32;
+
+		char*	_storage;
+		int*	_data;
+		size_t	_size;
+
+		void	allocate(size_t size);
+
+	public:
+		FixedVector();
+		explicit FixedVector(size_t size);
+		FixedVector(FixedVector const& src);
+		template <class E>
+		explicit FixedVector(FixedExpr<E> const& expr);
+		FixedVector& operator=(FixedVector const& rhs);
+		template <class E>
+		FixedVector& operator=(FixedExpr<E> const& expr);
+		~FixedVector();
+
+		size_t		size(void) const;
+		int*		data(void);
+		int const*	data(void) const;
+
+		int		getRaw(size_t i) const;
+		void	setRaw(size_t i, int raw);
+		float	toFloat(size_t i) const;
+		void	setFloat(size_t i, float value);
+		void	fill(int raw);
+};
+
+template <>
+struct FixedOperand<FixedVector> {
+	typedef FixedLeaf<FixedVector>	type;
+};
+
+// An expression with mismatched operands gives an empty vector.
+template <class E>
+FixedVector::FixedVector(FixedExpr<E> const& expr) : _storage(NULL), _data(NULL), _size(0) {
+	typename FixedOperand<E>::type	src(expr.self());
+
+	if (src.size() == FIXED_SIZE_MISMATCH) {
+		std::cerr << "Error: FixedVector size mismatch\n";
+		allocate(0);
+		return;
+	}
+	allocate(src.size());
+	for (size_t i = 0; i < _size; i++)
+		_data[i] = src[i];
+}
+
+// Sizes must match; the loop reads index i before writing it, so the
+// destination may also appear in the expression.
+template <class E>
+FixedVector&	FixedVector::operator=(FixedExpr<E> const& expr) {
+	typename FixedOperand<E>::type	src(expr.self());
+
+	if (src.size() != _size) {
+		std::cerr << "Error: FixedVector size mismatch\n";
+		return *this;
+	}
+	for (size_t i = 0; i < _size; i++)
+		_data[i] = src[i];
+	return *this;
+}
+
+#endif
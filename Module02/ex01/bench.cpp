@@ -0,0 +1,171 @@
+#include "FixedMatrix.hpp"
+#include "Bench.hpp"
+#include <sstream>
+#include <string>
+#if defined(__x86_64__) || defined(__i386__)
+# include <emmintrin.h>
+#endif
+
+static const size_t	N = 1 << 20;
+static const int	ROUNDS = 50;
+
+static float	src[N];
+static int		raw[N];
+static int		dst[N];
+
+static void	report(char const* name, unsigned long long start, int checksum, int rounds = ROUNDS) {
+	Bench::report("Fixed", name, start, static_cast<double>(N) * rounds, "value", checksum);
+}
+
+static int	checksum(void) {
+	unsigned int sum = 0;
+
+	for (size_t i = 0; i < N; i++)
+		sum = sum * 31 + static_cast<unsigned int>(dst[i]);
+	return static_cast<int>(sum);
+}
+
+int	main(void) {
+	unsigned int seed = 42;
+
+	for (size_t i = 0; i < N; i++) {
+		seed = seed * 1103515245 + 12345;
+		src[i] = (static_cast<int>(seed >> 8) % 2000000 - 1000000) / 97.0f;
+	}
+
+	unsigned long long start = Bench::now();
+	for (int r = 0; r < ROUNDS; r++)
+		for (size_t i = 0; i < N; i++)
+			dst[i] = static_cast<int>(roundf(src[i] * 256));
+	report("roundf(x * 256)", start, checksum());
+
+	start = Bench::now();
+	for (int r = 0; r < ROUNDS; r++)
+		for (size_t i = 0; i < N; i++)
+			dst[i] = Fixed::floatToRaw(src[i]);
+	report("floatToRaw nearest-away", start, checksum());
+
+	start = Bench::now();
+	for (int r = 0; r < ROUNDS; r++)
+		for (size_t i = 0; i < N; i++)
+			dst[i] = Fixed::floatToRaw(src[i], Fixed::ROUND_NEAREST_EVEN);
+	report("floatToRaw nearest-even", start, checksum());
+
+	start = Bench::now();
+	for (int r = 0; r < ROUNDS; r++)
+		for (size_t i = 0; i < N; i++)
+			dst[i] = Fixed::floatToRaw(src[i], Fixed::ROUND_FLOOR, Fixed::OVERFLOW_WRAP);
+	report("floatToRaw floor wrap", start, checksum());
+
+#if defined(__x86_64__) || defined(__i386__)
+	start = Bench::now();
+	for (int r = 0; r < ROUNDS; r++) {
+		__m128 scale = _mm_set1_ps(256.0f);
+		for (size_t i = 0; i + 4 <= N; i += 4)
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+				_mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(src + i), scale)));
+	}
+	report("cvtps2dq (nearest-even)", start, checksum());
+#endif
+
+	start = Bench::now();
+	for (int r = 0; r < ROUNDS; r++)
+		Fixed::fromFloatArray(src, dst, N);
+	report("Fixed::fromFloatArray", start, checksum());
+
+	for (size_t i = 0; i < N; i++)
+		raw[i] = dst[i] < 0 ? -dst[i] : dst[i];
+
+	start = Bench::now();
+	for (int r = 0; r < ROUNDS; r++)
+		for (size_t i = 0; i < N; i++)
+			dst[i] = static_cast<int>(roundf(sqrtf(raw[i] / 256.0f) * 256));
+	report("sqrtf through float", start, checksum());
+
+	start = Bench::now();
+	for (int r = 0; r < ROUNDS; r++)
+		for (size_t i = 0; i < N; i++)
+			dst[i] = Fixed::sqrtRaw(raw[i]);
+	report("Fixed::sqrtRaw", start, checksum());
+
+	start = Bench::now();
+	for (int r = 0; r < ROUNDS; r++)
+		for (size_t i = 0; i < N; i++)
+			dst[i] = static_cast<int>(roundf(sinf(raw[i] / 256.0f) * 256));
+	report("sinf through float", start, checksum());
+
+	start = Bench::now();
+	for (int r = 0; r < ROUNDS; r++)
+		for (size_t i = 0; i < N; i++)
+			dst[i] = Fixed::sinRaw(raw[i]);
+	report("Fixed::sinRaw", start, checksum());
+
+	std::ostringstream	os;
+	start = Bench::now();
+	for (size_t i = 0; i < N; i++)
+		os << raw[i] / 256.0f << '\n';
+	std::string text = os.str();
+	report("ostream << toFloat()", start, static_cast<int>(text.size()), 1);
+
+	char* buf = new char[N * Fixed::formatBufferSize];
+	size_t length = 0;
+	start = Bench::now();
+	for (int r = 0; r < ROUNDS; r++)
+		length = Fixed::formatArray(raw, N, buf, '\n');
+	report("Fixed::formatArray", start, static_cast<int>(length));
+
+	std::istringstream	is(std::string(buf, length));
+	float				value;
+	start = Bench::now();
+	for (size_t i = 0; i < N && is >> value; i++)
+		dst[i] = Fixed::floatToRaw(value);
+	report("istream >> float", start, checksum(), 1);
+
+	start = Bench::now();
+	for (int r = 0; r < ROUNDS; r++)
+		Fixed::parseArray(buf, buf + length, dst, N);
+	report("Fixed::parseArray", start, checksum());
+	delete[] buf;
+
+	FixedVector a(N), b(N), c(N), out(N);
+	for (size_t i = 0; i < N; i++) {
+		a.setRaw(i, raw[i] & 0xffff);
+		b.setRaw(i, raw[(i * 7) % N] & 0xffff);
+		c.setRaw(i, raw[(i * 13) % N]);
+	}
+	start = Bench::now();
+	for (int r = 0; r < ROUNDS; r++)
+		out = a * b + c;
+	for (size_t i = 0; i < N; i++)
+		dst[i] = out.getRaw(i);
+	report("FixedVector a * b + c", start, checksum());
+
+	const size_t	dim = 256;
+	FixedMatrix		ma(dim, dim), mb(dim, dim), mc(dim, dim);
+	float*			fa = new float[dim * dim];
+	float*			fb = new float[dim * dim];
+	float*			fc = new float[dim * dim];
+	for (size_t i = 0; i < dim * dim; i++) {
+		ma.data()[i] = raw[i] & 0x3ff;
+		mb.data()[i] = raw[i + dim * dim] & 0x3ff;
+		fa[i] = ma.data()[i] / 256.0f;
+		fb[i] = mb.data()[i] / 256.0f;
+	}
+	start = Bench::now();
+	FixedMatrix::multiply(ma, mb, mc);
+	report("FixedMatrix 256^3 (per MAC)", start, mc.data()[dim + 1], 16);
+
+	start = Bench::now();
+	for (size_t i = 0; i < dim; i++) {
+		for (size_t j = 0; j < dim; j++)
+			fc[i * dim + j] = 0.0f;
+		for (size_t k = 0; k < dim; k++)
+			for (size_t j = 0; j < dim; j++)
+				fc[i * dim + j] += fa[i * dim + k] * fb[k * dim + j];
+	}
+	report("float 256^3 (per MAC)", start, static_cast<int>(fc[dim + 1] * 256), 16);
+	delete[] fa;
+	delete[] fb;
+	delete[] fc;
+	return 0;
+}
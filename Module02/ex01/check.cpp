@@ -0,0 +1,490 @@
+#include "FixedMatrix.hpp"
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <climits>
+#include <sstream>
+#include <stdint.h>
+
+/*
+** FixedMath against libm (long double references). Every function is swept
+** over all raw values near zero and a geometric stride up to the ends of its
+** range; the worst error must stay within the bound documented in
+** FixedMath.cpp. Prints one line per function, exits 1 on any failure.
+** The batch kernels are then compared with their scalar references, and the
+** decimal text I/O is checked against exact integer and long double
+** references, and the expression templates for size mismatches last.
+*/
+
+typedef int			(*UnaryRaw)(int raw);
+typedef long double	(*UnaryRef)(long double x);
+
+static long double	refSqrt(long double x) { return std::sqrt(x); }
+static long double	refReciprocal(long double x) { return 1.0L / x; }
+static long double	refSin(long double x) { return std::sin(x); }
+static long double	refCos(long double x) { return std::cos(x); }
+static long double	refExp2(long double x) { return std::pow(2.0L, x); }
+static long double	refLog2(long double x) { return std::log(x) / std::log(2.0L); }
+
+static int	failures = 0;
+
+static void	result(char const* name, long double worst, long double bound, long count) {
+	bool ok = worst <= bound + 1e-9L;
+
+	std::cout << (ok ? "ok   " : "FAIL ") << name << ": worst " << static_cast<double>(worst)
+		<< " LSB (bound " << static_cast<double>(bound) << ") over " << count << " inputs" << std::endl;
+	if (!ok)
+		failures++;
+}
+
+// Every raw in [-2^16, 2^16], then steps of 1 + |raw| / 2^16 out to the range.
+static int64_t	nextInput(int64_t raw) {
+	int64_t magnitude = raw < 0 ? -raw : raw;
+
+	return raw + 1 + (magnitude > 65536 ? magnitude >> 16 : 0);
+}
+
+/*
+** Error in LSB of fn(raw) against ref(raw / 256) * 256 on [begin, end]; a
+** relative term adds relative * |reference| to the allowed error.
+*/
+static void	checkUnary(char const* name, UnaryRaw fn, UnaryRef ref,
+	int64_t begin, int64_t end, long double bound, long double relative = 0) {
+	long double	worst = 0;
+	long		count = 0;
+
+	for (int64_t raw = begin; raw <= end; raw = nextInput(raw)) {
+		if (raw == 0 && fn == Fixed::reciprocalRaw)
+			continue;
+
+		long double expected = ref(raw / 256.0L) * 256.0L;
+		long double error = std::fabs(fn(static_cast<int>(raw)) - expected) - relative * std::fabs(expected);
+
+		if (error > worst)
+			worst = error;
+		count++;
+	}
+	result(name, worst, bound, count);
+}
+
+static void	checkAtan2(void) {
+	long double	worst = 0;
+	long		count = 0;
+	uint32_t	seed = 7;
+
+	for (int i = 0; i < 2000000; i++) {
+		seed = seed * 1664525u + 1013904223u;
+		int y = static_cast<int>(seed) >> (seed & 15);
+		seed = seed * 1664525u + 1013904223u;
+		int x = static_cast<int>(seed) >> (seed & 15);
+		if (x == 0 && y == 0)
+			continue;
+
+		long double error = std::fabs(Fixed::atan2Raw(y, x)
+			- std::atan2(static_cast<long double>(y), static_cast<long double>(x)) * 256.0L);
+		if (error > worst)
+			worst = error;
+		count++;
+	}
+	result("atan2Raw", worst, 0.51L, count);
+}
+
+static void	checkEdges(void) {
+	bool ok = Fixed::sqrtRaw(-5) == 0 && Fixed::sqrtRaw(0) == 0
+		&& Fixed::reciprocalRaw(0) == INT_MAX && Fixed::atan2Raw(0, 0) == 0
+		&& Fixed::exp2Raw(INT_MAX) == INT_MAX && Fixed::exp2Raw(INT_MIN) == 0
+		&& Fixed::log2Raw(0) == INT_MIN && Fixed::log2Raw(-1) == INT_MIN;
+
+	std::cout << (ok ? "ok   " : "FAIL ") << "edge cases (negative sqrt, 1/0, atan2(0, 0), "
+		<< "exp2 saturation, log2 of non-positive)" << std::endl;
+	if (!ok)
+		failures++;
+}
+
+// floatToRaw() by long double: x * 256 is exact there, as is the rounding.
+static int	referenceFloatToRaw(float x, Fixed::RoundMode mode, Fixed::OverflowMode overflow) {
+	long double	value = static_cast<long double>(x) * 256;
+
+	if (x != x)
+		return 0;
+	if (mode == Fixed::ROUND_NEAREST_EVEN)
+		value = nearbyintl(value);
+	else if (mode == Fixed::ROUND_NEAREST_AWAY)
+		value = roundl(value);
+	else if (mode == Fixed::ROUND_TRUNCATE)
+		value = truncl(value);
+	else
+		value = floorl(value);
+	if (overflow == Fixed::OVERFLOW_SATURATE)
+		return value >= INT_MAX ? INT_MAX : value <= INT_MIN ? INT_MIN : static_cast<int>(value);
+	if (value != value + 1)
+		value = fmodl(value, 4294967296.0L);
+	else
+		value = 0;
+	return static_cast<int>(static_cast<uint32_t>(static_cast<int64_t>(value)));
+}
+
+static float	floatFromBits(uint32_t bits) {
+	float x;
+
+	std::memcpy(&x, &bits, sizeof(x));
+	return x;
+}
+
+/*
+** Every rounding and overflow mode over a stride of all bit patterns (both
+** signs, subnormals, NaN, infinities), plus every half-way point and its
+** neighbours near zero.
+*/
+static void	checkFloatToRaw(void) {
+	long	count = 0;
+	long	wrong = 0;
+
+	for (int m = 0; m < 4; m++) {
+		for (int o = 0; o < 2; o++) {
+			Fixed::RoundMode	mode = static_cast<Fixed::RoundMode>(m);
+			Fixed::OverflowMode	overflow = static_cast<Fixed::OverflowMode>(o);
+
+			for (uint64_t bits = 0; bits <= 0xffffffffu; bits += 997) {
+				float x = floatFromBits(static_cast<uint32_t>(bits));
+				wrong += Fixed::floatToRaw(x, mode, overflow) != referenceFloatToRaw(x, mode, overflow);
+				count++;
+			}
+			for (int k = -4096; k <= 4096; k++) {
+				float half = (k + 0.5f) / 256;
+				float near[] = {half, nextafterf(half, 0), nextafterf(half, 2 * half), k / 256.0f,
+					floatFromBits(0x7f800000u), floatFromBits(0xff800000u), floatFromBits(0x7fc00000u),
+					floatFromBits(0x00000001u), floatFromBits(0x807fffffu),
+					8388608.0f, -8388608.0f, nextafterf(8388608.0f, 0), nextafterf(-8388608.0f, 0)};
+				for (size_t i = 0; i < sizeof(near) / sizeof(near[0]); i++) {
+					wrong += Fixed::floatToRaw(near[i], mode, overflow)
+						!= referenceFloatToRaw(near[i], mode, overflow);
+					count++;
+				}
+			}
+		}
+	}
+	std::cout << (wrong ? "FAIL " : "ok   ") << "floatToRaw, 4 rounding x 2 overflow modes: "
+		<< wrong << " wrong of " << count << " inputs" << std::endl;
+	if (wrong)
+		failures++;
+}
+
+// Odd tails too: AVX2 takes 8 lanes, SSE2 the next 4, the scalar code the rest.
+static const size_t	LENGTHS[] = {0, 1, 3, 4, 5, 7, 8, 12, 13, 1003, 1007, 1021};
+static const size_t	LENGTH_COUNT = sizeof(LENGTHS) / sizeof(LENGTHS[0]);
+static const size_t	MAX_LENGTH = 1024;
+
+typedef void	(*BinaryKernel)(int const* a, int const* b, int* dst, size_t n);
+
+static uint32_t	g_seed = 99;
+
+static uint32_t	nextRandom(void) {
+	g_seed = g_seed * 1664525u + 1013904223u;
+	return g_seed;
+}
+
+// Random raws with saturating pairs (INT_MAX + 1, INT_MIN + -1) spread in.
+static void	fillRaw(int* a, int* b, size_t n, uint32_t mask) {
+	static int const	edges[][2] = {{INT_MAX, 1}, {INT_MIN, -1}, {INT_MAX, INT_MAX},
+		{INT_MIN, INT_MIN}, {INT_MIN, INT_MAX}, {-1, 1}, {0, 0}};
+
+	for (size_t i = 0; i < n; i++) {
+		a[i] = static_cast<int>(nextRandom() & mask) - static_cast<int>(mask >> 1);
+		b[i] = static_cast<int>(nextRandom() & mask) - static_cast<int>(mask >> 1);
+		if (mask == 0xffffffffu && nextRandom() % 5 == 0) {
+			a[i] = edges[i % 7][0];
+			b[i] = edges[i % 7][1];
+		}
+	}
+}
+
+static void	checkBinary(char const* name, BinaryKernel kernel, BinaryKernel reference) {
+	int		a[MAX_LENGTH], b[MAX_LENGTH], got[MAX_LENGTH], expected[MAX_LENGTH];
+	bool	ok = true;
+
+	for (size_t l = 0; l < LENGTH_COUNT; l++) {
+		size_t n = LENGTHS[l];
+
+		fillRaw(a, b, n, 0xffffffffu);
+		kernel(a, b, got, n);
+		reference(a, b, expected, n);
+		ok = ok && std::memcmp(got, expected, n * sizeof(int)) == 0;
+	}
+	std::cout << (ok ? "ok   " : "FAIL ") << name << " matches its scalar reference" << std::endl;
+	if (!ok)
+		failures++;
+}
+
+// Sums stay within int64: 20-bit raws for dot and fir.
+static void	checkAccumulating(void) {
+	int		a[MAX_LENGTH], b[MAX_LENGTH], got[MAX_LENGTH], expected[MAX_LENGTH];
+	bool	ok = true;
+
+	for (size_t l = 0; l < LENGTH_COUNT; l++) {
+		size_t n = LENGTHS[l];
+
+		fillRaw(a, b, n, 0xfffffu);
+		ok = ok && Fixed::dot(a, b, n) == Fixed::dotScalar(a, b, n);
+
+		size_t taps[] = {1, 3, 8, 17, n, n + 5};
+		for (size_t t = 0; t < sizeof(taps) / sizeof(taps[0]); t++) {
+			if (taps[t] > MAX_LENGTH)
+				continue;
+			for (size_t i = 0; i < MAX_LENGTH; i++)
+				got[i] = expected[i] = 12345;
+			Fixed::fir(a, n, b, taps[t], got);
+			Fixed::firScalar(a, n, b, taps[t], expected);
+			ok = ok && std::memcmp(got, expected, sizeof(got)) == 0;
+		}
+	}
+	std::cout << (ok ? "ok   " : "FAIL ") << "dot and fir (nTaps up to n + 5) match their scalar references"
+		<< std::endl;
+	if (!ok)
+		failures++;
+}
+
+// Every cell against dotScalar() on its row and column; partial panels included.
+static void	checkMultiply(void) {
+	static const size_t	shapes[][3] = {{1, 1, 1}, {3, 5, 7}, {64, 64, 64}, {65, 129, 63}, {130, 70, 1}};
+	int					column[MAX_LENGTH];
+	bool				ok = true;
+
+	for (size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++) {
+		size_t		m = shapes[s][0];
+		size_t		inner = shapes[s][1];
+		size_t		n = shapes[s][2];
+		FixedMatrix	a(m, inner), b(inner, n), out(m, n);
+
+		for (size_t i = 0; i < a.size(); i++)
+			a.data()[i] = static_cast<int>(nextRandom() & 0xfffffu) - 0x7ffff;
+		for (size_t i = 0; i < b.size(); i++)
+			b.data()[i] = static_cast<int>(nextRandom() & 0xfffffu) - 0x7ffff;
+		ok = ok && FixedMatrix::multiply(a, b, out);
+		for (size_t j = 0; j < n; j++) {
+			for (size_t k = 0; k < inner; k++)
+				column[k] = b.getRaw(k, j);
+			for (size_t i = 0; i < m; i++)
+				ok = ok && out.getRaw(i, j) == Fixed::dotScalar(a.data() + i * inner, column, inner);
+		}
+	}
+	std::cout << (ok ? "ok   " : "FAIL ") << "FixedMatrix::multiply matches dotScalar on every row and column"
+		<< std::endl;
+	if (!ok)
+		failures++;
+}
+
+static void	checkFloatKernels(void) {
+	float const	edges[] = {9e6f, 1e10f, 3.4e38f, -9e6f, -1e10f, -3.4e38f,
+		std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+		std::numeric_limits<float>::quiet_NaN(), 8388608.0f, -8388608.0f, 8388607.99f,
+		0.5f / 256, -0.5f / 256, 1.5f / 256, -2.5f / 256, 1e-40f, -0.0f};
+	size_t		edgeCount = sizeof(edges) / sizeof(edges[0]);
+	float		src[MAX_LENGTH], back[MAX_LENGTH], backExpected[MAX_LENGTH];
+	int			got[MAX_LENGTH], expected[MAX_LENGTH];
+	bool		ok = true;
+
+	for (size_t l = 0; l < LENGTH_COUNT; l++) {
+		size_t n = LENGTHS[l];
+
+		for (size_t i = 0; i < n; i++) {
+			src[i] = (static_cast<int>(nextRandom() >> 8) % 2000000 - 1000000) / 97.0f;
+			if (nextRandom() % 4 == 0)
+				src[i] = edges[nextRandom() % edgeCount];
+		}
+		Fixed::fromFloatArray(src, got, n);
+		Fixed::fromFloatArrayScalar(src, expected, n);
+		ok = ok && std::memcmp(got, expected, n * sizeof(int)) == 0;
+		Fixed::toFloatArray(got, back, n);
+		Fixed::toFloatArrayScalar(got, backExpected, n);
+		ok = ok && std::memcmp(back, backExpected, n * sizeof(float)) == 0;
+	}
+	// The kernels saturate like Fixed(float): 8 lanes of each edge case.
+	for (size_t e = 0; e < edgeCount; e++) {
+		for (size_t i = 0; i < 13; i++)
+			src[i] = edges[e];
+		Fixed::fromFloatArray(src, got, 13);
+		for (size_t i = 0; i < 13; i++)
+			ok = ok && got[i] == Fixed::floatToRaw(edges[e]);
+	}
+	ok = ok && got[0] == 0 && Fixed::floatToRaw(1e10f) == INT_MAX && Fixed::floatToRaw(-1e10f) == INT_MIN;
+	std::cout << (ok ? "ok   " : "FAIL ") << "fromFloatArray and toFloatArray match their scalar "
+		<< "references (out of range saturates, NaN is 0)" << std::endl;
+	if (!ok)
+		failures++;
+}
+
+/*
+** text is the exact decimal form of raw: an optional '-' (not for 0), the
+** whole part, then at most 8 fractional digits without a trailing zero.
+*/
+static bool	isExactText(char const* text, size_t length, int raw) {
+	char const*	p = text;
+	char const*	end = text + length;
+	bool		negative = p < end && *p == '-';
+	uint64_t	whole = 0;
+	uint64_t	frac = 0;
+	uint64_t	scale = 1;
+
+	if (negative)
+		p++;
+	if (p == end || *p < '0' || *p > '9')
+		return false;
+	for (; p < end && *p >= '0' && *p <= '9'; p++)
+		whole = whole * 10 + (*p - '0');
+	if (p < end) {
+		if (*p++ != '.' || p == end || end - p > 8 || end[-1] == '0')
+			return false;
+		for (; p < end; p++) {
+			if (*p < '0' || *p > '9')
+				return false;
+			frac = frac * 10 + (*p - '0');
+			scale *= 10;
+		}
+	}
+	if ((frac << 8) % scale)
+		return false;
+
+	int64_t magnitude = static_cast<int64_t>((whole << 8) + (frac << 8) / scale);
+	return (negative ? -magnitude : magnitude) == raw && (raw != 0 || !negative);
+}
+
+// "ddd.ffff" by long double: the fraction alone is rounded, half away from zero.
+static bool	referenceParse(bool negative, uint64_t whole, uint64_t frac, int digits, int& raw) {
+	long double	scaled = static_cast<long double>(frac) * 256;
+	int64_t		magnitude;
+
+	for (int i = 0; i < digits; i++)
+		scaled /= 10;
+	magnitude = static_cast<int64_t>(whole) * 256 + static_cast<int64_t>(roundl(scaled));
+	if (magnitude > (negative ? 2147483648LL : 2147483647LL))
+		return false;
+	raw = static_cast<int>(negative ? -magnitude : magnitude);
+	return true;
+}
+
+// nextInput() stopping on INT_MAX rather than stepping over it.
+static int64_t	nextInputToMax(int64_t raw) {
+	int64_t next = nextInput(raw);
+
+	return raw < INT_MAX && next > INT_MAX ? INT_MAX : next;
+}
+
+static void	checkFormat(void) {
+	char		buf[Fixed::formatBufferSize];
+	long		count = 0;
+	bool		ok = true;
+
+	// formatRaw then parseRaw on the nextInput() sweep and both ends.
+	for (int64_t raw = INT_MIN; raw <= INT_MAX; raw = nextInputToMax(raw)) {
+		int		value = static_cast<int>(raw);
+		size_t	length = Fixed::formatRaw(value, buf);
+		int		back = value + 1;
+
+		ok = ok && length < sizeof(buf) && buf[length] == '\0' && isExactText(buf, length, value)
+			&& Fixed::parseRaw(buf, buf + length, back) == buf + length && back == value;
+		count++;
+	}
+
+	// Random decimals up to 12 fractional digits, ties at every 1/512 included,
+	// whole parts around 2^23 for the range limits.
+	for (int i = 0; i < 200000; i++) {
+		bool		negative = nextRandom() % 2;
+		uint64_t	whole = nextRandom() % 3 ? nextRandom() % 1000 : (1u << 23) + 1 - nextRandom() % 4;
+		int			digits = nextRandom() % 13;
+		uint64_t	frac = 0;
+		std::string	text = negative ? "-" : nextRandom() % 2 ? "+" : "";
+		int			got = 0;
+		int			expected = 0;
+
+		for (int d = 0; d < digits; d++)
+			frac = frac * 10 + nextRandom() % 10;
+		if (i % 4 == 0) {
+			digits = 9;
+			frac = (2 * (nextRandom() % 256) + 1) * 1953125u;
+		}
+
+		std::ostringstream os;
+		os << whole;
+		if (digits) {
+			os << '.';
+			os.width(digits);
+			os.fill('0');
+			os << frac;
+		}
+		text += os.str();
+
+		char const*	end = Fixed::parseRaw(text.data(), text.data() + text.size(), got);
+		bool		fits = referenceParse(negative, whole, frac, digits, expected);
+
+		ok = ok && (fits ? end == text.data() + text.size() && got == expected : end == NULL);
+		count++;
+	}
+
+	// Arrays of every length, then separator runs and a malformed field.
+	char*	text = new char[MAX_LENGTH * Fixed::formatBufferSize];
+	int		raw[MAX_LENGTH], dummy[MAX_LENGTH], back[MAX_LENGTH];
+
+	for (size_t l = 0; l < LENGTH_COUNT; l++) {
+		size_t n = LENGTHS[l];
+
+		fillRaw(raw, dummy, n, 0xffffffffu);
+		for (size_t s = 0; s < 2; s++) {
+			size_t length = Fixed::formatArray(raw, n, text, s ? '\n' : ',');
+
+			ok = ok && Fixed::parseArray(text, text + length, back, MAX_LENGTH) == n
+				&& std::memcmp(raw, back, n * sizeof(int)) == 0
+				&& Fixed::parseArray(text, text + length, back, n / 2) == n / 2;
+			count++;
+		}
+	}
+	delete[] text;
+
+	char const	mixed[] = " 1;\r\n-2.5 ,\t+0.00390625,,42 x,7";
+	ok = ok && Fixed::parseArray(mixed, mixed + sizeof(mixed) - 1, back, MAX_LENGTH) == 4
+		&& back[0] == 256 && back[1] == -640 && back[2] == 1 && back[3] == 42 * 256;
+	std::cout << (ok ? "ok   " : "FAIL ") << "formatRaw / parseRaw / formatArray / parseArray: exact "
+		<< "text, round-trips, half-away rounding over " << count << " inputs" << std::endl;
+	if (!ok)
+		failures++;
+}
+
+// Mismatched operands must be rejected without reading past the shorter one.
+static void	checkSizeMismatch(void) {
+	FixedVector	a(1000);
+	FixedVector	b(10);
+	FixedVector	out(1000);
+
+	a.fill(256);
+	b.fill(256);
+	out = a + b * a;
+
+	FixedVector	built(a - b);
+	bool		ok = out.getRaw(999) == 0 && built.size() == 0 && fixedDot(a, b) == 0;
+
+	std::cout << (ok ? "ok   " : "FAIL ") << "FixedVector size mismatch rejected" << std::endl;
+	if (!ok)
+		failures++;
+}
+
+int	main(void) {
+	checkUnary("sqrtRaw", Fixed::sqrtRaw, refSqrt, 1, INT_MAX, 0.5L);
+	checkUnary("reciprocalRaw", Fixed::reciprocalRaw, refReciprocal, INT_MIN, INT_MAX, 0.5L);
+	checkUnary("sinRaw", Fixed::sinRaw, refSin, INT_MIN, INT_MAX, 0.505L);
+	checkUnary("cosRaw", Fixed::cosRaw, refCos, INT_MIN, INT_MAX, 0.505L);
+	checkAtan2();
+	// exp2 while the result fits (below 2^23): 2^-30 relative on top of 0.5 LSB
+	checkUnary("exp2Raw", Fixed::exp2Raw, refExp2, -32 * 256, 23 * 256 - 1, 0.5L, 1.0L / (1 << 30));
+	checkUnary("log2Raw", Fixed::log2Raw, refLog2, 1, INT_MAX, 0.5L + 1.0L / 4096);
+	checkEdges();
+	checkFloatToRaw();
+	checkBinary("addArray", Fixed::addArray, Fixed::addArrayScalar);
+	checkBinary("addSatArray", Fixed::addSatArray, Fixed::addSatArrayScalar);
+	checkBinary("mulArray", Fixed::mulArray, Fixed::mulArrayScalar);
+	checkAccumulating();
+	checkMultiply();
+	checkFloatKernels();
+	checkFormat();
+	checkSizeMismatch();
+	return failures ? 1 : 0;
+}
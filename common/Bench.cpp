@@ -0,0 +1,49 @@
+#include "Bench.hpp"
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <ctime>
+
+unsigned long long	Bench::now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<unsigned long long>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+};
+
+static void	writeJsonString(char const* str) {
+	std::cout << '"';
+	for (; *str; str++) {
+		if (*str == '"' || *str == '\\')
+			std::cout << '\\';
+		std::cout << *str;
+	}
+	std::cout << '"';
+}
+
+void	Bench::report(char const* suite, char const* name, unsigned long long start,
+	double ops, char const* unit, long checksum) {
+	reportElapsed(suite, name, now() - start, ops, unit, checksum);
+};
+
+void	Bench::reportElapsed(char const* suite, char const* name, unsigned long long elapsedNs,
+	double ops, char const* unit, long checksum) {
+	double	perOp = ops > 0 ? static_cast<double>(elapsedNs) / ops : 0;
+
+	if (std::getenv("BENCH_JSON")) {
+		std::cout << "{\"suite\":";
+		writeJsonString(suite);
+		std::cout << ",\"bench\":";
+		writeJsonString(name);
+		std::cout << ",\"unit\":";
+		writeJsonString(unit);
+		std::cout << std::fixed << std::setprecision(3)
+					<< ",\"ns_per_op\":" << perOp
+					<< ",\"ops\":" << std::setprecision(0) << ops
+					<< ",\"checksum\":" << checksum << "}" << std::endl;
+		return;
+	}
+	std::cout << std::left << std::setw(32) << name
+				<< std::right << std::setw(10) << std::fixed << std::setprecision(3) << perOp
+				<< " ns/" << unit << "  (checksum " << checksum << ")" << std::endl;
+};
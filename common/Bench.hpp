@@ -0,0 +1,24 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+/*
+** Timing/report helper shared by the exercise benchmarks. report() times
+** from a now() stamp, reportElapsed() takes a total summed by the caller.
+** Both print a table line, or one JSON object per line when BENCH_JSON is
+** set (what the top-level `make bench` collects into bench_results.jsonl).
+*/
+class Bench {
+	private:
+		Bench();
+
+	public:
+		static unsigned long long	now(void);
+		static void					report(char const* suite, char const* name,
+										unsigned long long start, double ops,
+										char const* unit, long checksum);
+		static void					reportElapsed(char const* suite, char const* name,
+										unsigned long long elapsedNs, double ops,
+										char const* unit, long checksum);
+};
+
+#endif
@@ -0,0 +1,186 @@
+#include "Trace.hpp"
+
+#ifdef TRACE_ENABLED
+
+# include <fstream>
+# include <iostream>
+# include <string>
+# include <cstdlib>
+# include <ctime>
+# include <pthread.h>
+
+static const unsigned	CHUNK_EVENTS = 4096;
+
+struct TraceEvent {
+	char const*			name;
+	unsigned long long	start;
+	unsigned long long	end;
+};
+
+struct TraceChunk {
+	TraceEvent	events[CHUNK_EVENTS];
+	unsigned	count;
+	TraceChunk*	next;
+};
+
+// One per thread, linked under g_lock on first use and kept until exit.
+// lock guards the chunks: the owner thread and flush() are its only users.
+struct TraceBuffer {
+	pthread_mutex_t	lock;
+	TraceChunk*		head;
+	TraceChunk*		tail;
+	unsigned		tid;
+	TraceBuffer*	next;
+};
+
+// A file this process has flushed to: later flushes to it append.
+struct TraceFile {
+	std::string	path;
+	bool		hasEvents;
+	TraceFile*	next;
+};
+
+// g_lock guards the buffer and file lists.
+static pthread_mutex_t		g_lock = PTHREAD_MUTEX_INITIALIZER;
+static TraceBuffer*			g_buffers = NULL;
+static TraceFile*			g_files = NULL;
+static unsigned				g_nextTid = 1;
+static __thread TraceBuffer*	t_buffer = NULL;
+
+static void	flushAtExit(void) {
+	char const* path = std::getenv("TRACE_FILE");
+
+	Trace::flush(path ? path : "trace.json");
+}
+
+static TraceBuffer*	localBuffer(void) {
+	if (!t_buffer) {
+		t_buffer = new TraceBuffer();
+		pthread_mutex_init(&t_buffer->lock, NULL);
+		t_buffer->head = new TraceChunk();
+		t_buffer->tail = t_buffer->head;
+		pthread_mutex_lock(&g_lock);
+		if (!g_buffers)
+			std::atexit(flushAtExit);
+		t_buffer->tid = g_nextTid++;
+		t_buffer->next = g_buffers;
+		g_buffers = t_buffer;
+		pthread_mutex_unlock(&g_lock);
+	}
+	return t_buffer;
+}
+
+TraceSpan::TraceSpan(char const* name) : _name(name), _start(Trace::now()) {};
+
+TraceSpan::~TraceSpan() {
+	Trace::record(_name, _start, Trace::now());
+};
+
+unsigned long long	Trace::now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<unsigned long long>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+};
+
+void	Trace::record(char const* name, unsigned long long start, unsigned long long end) {
+	TraceBuffer*	buffer = localBuffer();
+
+	pthread_mutex_lock(&buffer->lock);
+	TraceChunk* chunk = buffer->tail;
+	if (chunk->count == CHUNK_EVENTS) {
+		chunk->next = new TraceChunk();
+		chunk = chunk->next;
+		buffer->tail = chunk;
+	}
+	TraceEvent& event = chunk->events[chunk->count++];
+	event.name = name;
+	event.start = start;
+	event.end = end;
+	pthread_mutex_unlock(&buffer->lock);
+};
+
+// Chrome wants microseconds; keep the nanoseconds as three decimals.
+static void	writeMicros(std::ostream& out, unsigned long long ns) {
+	unsigned long long	frac = ns % 1000;
+
+	out << ns / 1000 << '.' << frac / 100 << (frac / 10) % 10 << frac % 10;
+}
+
+static void	writeName(std::ostream& out, char const* name) {
+	for (; *name; name++) {
+		if (*name == '"' || *name == '\\')
+			out << '\\';
+		out << *name;
+	}
+}
+
+// Moves a thread's spans out as JSON events; keeps one emptied chunk for reuse.
+static void	drainBuffer(TraceBuffer* buffer, std::ostream& out, bool& first) {
+	pthread_mutex_lock(&buffer->lock);
+	for (TraceChunk* c = buffer->head; c; c = c->next) {
+		for (unsigned i = 0; i < c->count; i++) {
+			TraceEvent const& e = c->events[i];
+			out << (first ? "\n" : ",\n") << "{\"name\":\"";
+			writeName(out, e.name);
+			out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid << ",\"ts\":";
+			writeMicros(out, e.start);
+			out << ",\"dur\":";
+			writeMicros(out, e.end - e.start);
+			out << "}";
+			first = false;
+		}
+	}
+	TraceChunk* extra = buffer->head->next;
+	while (extra) {
+		TraceChunk* next = extra->next;
+		delete extra;
+		extra = next;
+	}
+	buffer->head->count = 0;
+	buffer->head->next = NULL;
+	buffer->tail = buffer->head;
+	pthread_mutex_unlock(&buffer->lock);
+}
+
+/*
+** Writes every span recorded so far as "complete" (ph: X) events of a JSON
+** array trace and empties the buffers. Timestamps are CLOCK_MONOTONIC, so
+** events from several flushes line up. The first flush to a path creates
+** the file; later ones to the same path reopen it, overwrite the closing
+** "]" and append, so the file is valid JSON after every flush.
+*/
+bool	Trace::flush(char const* path) {
+	pthread_mutex_lock(&g_lock);
+
+	TraceFile* file = g_files;
+	while (file && file->path != path)
+		file = file->next;
+
+	std::fstream out(path, file ? std::ios::in | std::ios::out : std::ios::out | std::ios::trunc);
+	if (!out.is_open()) {
+		pthread_mutex_unlock(&g_lock);
+		std::cerr << "Error: cannot open trace file " << path << "\n";
+		return false;
+	}
+	if (file)
+		out.seekp(-3, std::ios::end);
+	else {
+		file = new TraceFile();
+		file->path = path;
+		file->hasEvents = false;
+		file->next = g_files;
+		g_files = file;
+		out << "[";
+	}
+
+	bool first = !file->hasEvents;
+	for (TraceBuffer* b = g_buffers; b; b = b->next)
+		drainBuffer(b, out, first);
+	file->hasEvents = !first;
+	out << "\n]\n";
+	pthread_mutex_unlock(&g_lock);
+	return true;
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+/*
+** Scoped wall-time spans, written as Chrome/Perfetto trace JSON
+** (chrome://tracing, ui.perfetto.dev). Enabled with -DTRACE_ENABLED
+** (`make re TRACE=1`); otherwise TRACE_SPAN expands to nothing.
+**
+**   void FileHandler::replaceOccurence() {
+**       TRACE_SPAN("FileHandler::replaceOccurence");
+**       ...
+**
+** Spans are appended to a per-thread buffer under that buffer's own lock,
+** which only Trace::flush() ever contends for. They are written at exit to
+** $TRACE_FILE (default: trace.json), or earlier with Trace::flush(), which
+** is safe while other threads trace. Repeated flushes to the same path
+** append, so the exit flush extends an earlier flush of trace.json.
+*/
+
+#ifdef TRACE_ENABLED
+
+class Trace {
+	private:
+		Trace();
+
+	public:
+		static unsigned long long	now(void);
+		static void					record(char const* name, unsigned long long start, unsigned long long end);
+		static bool					flush(char const* path);
+};
+
+class TraceSpan {
+	private:
+		char const*			_name;
+		unsigned long long	_start;
+
+		TraceSpan(TraceSpan const& src);
+		TraceSpan& operator=(TraceSpan const& rhs);
+
+	public:
+		TraceSpan(char const* name);
+		~TraceSpan();
+};
+
+# define TRACE_CONCAT_(a, b) a##b
+# define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+# define TRACE_SPAN(name) TraceSpan TRACE_CONCAT(traceSpan_, __LINE__)(name)
+
+#else
+
+# define TRACE_SPAN(name)
+
+#endif
+
+#endif
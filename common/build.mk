@@ -0,0 +1,64 @@
+# Shared build variants, included at the end of every exercise Makefile.
+#
+#   make                    the plain 42 build, flags from the Makefile only
+#   make re BUILD=release   -O3 -march=native with parallel LTO (-flto=auto)
+#   make pgo                instrumented build, training run, optimized rebuild
+#   make bench              build BENCH_SRCS + common/Bench.cpp and run it
+#   make check              build CHECK_SRCS and run it; fails on any mismatch
+#
+# Before the include an exercise may set PGO_TRAIN (command run on the
+# instrumented binary, default ./$(NAME)), BENCH_NAME, BENCH_SRCS,
+# BENCH_DEPS (targets the benchmark needs built first), CHECK_NAME and
+# CHECK_SRCS.
+#
+# Sources shared from a common directory (SRCS += ../../common/Trace.cpp)
+# build into the exercise directory, so each exercise compiles them with its
+# own flags and BUILD variant: such Makefiles name objects with
+# OBJS = $(notdir $(SRCS:.cpp=.o)) and find the sources with
+# vpath %.cpp $(sort $(dir $(SRCS))).
+
+COMMON_DIR := $(dir $(lastword $(MAKEFILE_LIST)))
+
+BUILD ?= default
+RELEASE_FLAGS = -O3 -march=native -flto=auto
+
+ifeq ($(BUILD),release)
+BUILD_FLAGS = $(RELEASE_FLAGS)
+BUILD_LDFLAGS = $(RELEASE_FLAGS)
+else ifeq ($(BUILD),pgo-gen)
+BUILD_FLAGS = $(RELEASE_FLAGS) -fprofile-generate -fprofile-update=atomic
+BUILD_LDFLAGS = $(RELEASE_FLAGS) -fprofile-generate -fprofile-update=atomic
+else ifeq ($(BUILD),pgo-use)
+BUILD_FLAGS = $(RELEASE_FLAGS) -fprofile-use -fprofile-correction -Wno-missing-profile
+BUILD_LDFLAGS = $(RELEASE_FLAGS) -fprofile-use
+else ifneq ($(BUILD),default)
+$(error Unknown BUILD '$(BUILD)': use default, release, pgo-gen or pgo-use)
+endif
+
+PGO_TRAIN ?= ./$(NAME) > /dev/null
+
+# Both phases share RELEASE_FLAGS so the profile matches the rebuilt code;
+# profiles (*.gcda) are dropped first so a stale run never feeds the rebuild.
+pgo:
+	rm -f *.gcda
+	$(MAKE) re BUILD=pgo-gen
+	$(PGO_TRAIN)
+	$(MAKE) re BUILD=pgo-use
+
+# Exercises use CXXFLAGS, CFLAGS or FLAGS for their warnings; only one is set.
+# The benchmark is always rebuilt so it matches the requested BUILD.
+ifdef BENCH_SRCS
+bench: $(BENCH_DEPS)
+	$(CXX) $(CXXFLAGS) $(CFLAGS) $(FLAGS) $(if $(BUILD_FLAGS),$(BUILD_FLAGS),-O2) -I$(COMMON_DIR) \
+		$(BENCH_SRCS) $(COMMON_DIR)Bench.cpp -o $(BENCH_NAME) $(BUILD_LDFLAGS) $(LDFLAGS)
+	./$(BENCH_NAME)
+endif
+
+ifdef CHECK_SRCS
+check:
+	$(CXX) $(CXXFLAGS) $(CFLAGS) $(FLAGS) $(if $(BUILD_FLAGS),$(BUILD_FLAGS),-O2) \
+		$(CHECK_SRCS) -o $(CHECK_NAME) $(BUILD_LDFLAGS) $(LDFLAGS)
+	./$(CHECK_NAME)
+endif
+
+.PHONY: pgo bench check